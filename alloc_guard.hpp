@@ -0,0 +1,57 @@
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// 堆分配检查：播放线程在稳态区间（读取与处理缓冲区）内申请堆内存时计数，并调用可选的处理函数
+// 本身不拦截分配，需由应用把分配钩子接到on_alloc()：
+//   主机上替换全局operator new，RT-Thread上使用rt_malloc_sethook()
+// 区间按线程计数，其他线程（如LVGL）的分配不受影响
+class AllocGuard {
+    static inline thread_local uint32_t depth{};
+    static inline std::atomic<uint32_t> violations{};
+    static inline std::atomic<void (*)(size_t)> handler{};
+public:
+    // 标记当前线程进入不允许分配的区间，可嵌套
+    class Scope {
+    public:
+        Scope() { ++depth; }
+        ~Scope() { --depth; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+    // 在区间内临时允许分配，只用于已知会分配且无法避免的调用：打开文件时文件系统申请内存
+    // （glibc的fopen申请FILE，RT-Thread的DFS申请文件描述符、elm FatFs为每个文件rt_malloc一个FIL）
+    class Allow {
+        uint32_t saved;
+    public:
+        Allow() : saved(std::exchange(depth, 0)) {}
+        ~Allow() { depth = saved; }
+        Allow(const Allow&) = delete;
+        Allow& operator=(const Allow&) = delete;
+    };
+
+    // 由分配钩子调用
+    static void on_alloc(size_t size) {
+        if (!depth)
+            return;
+        violations.fetch_add(1, std::memory_order_relaxed);
+        if (auto h = handler.load(std::memory_order_acquire))
+            h(size);
+    }
+    // 发生违规分配时调用，例如在主机测试中直接中止
+    static void set_handler(void (*h)(size_t)) {
+        handler.store(h, std::memory_order_release);
+    }
+    static uint32_t count() {
+        return violations.load(std::memory_order_relaxed);
+    }
+    static void reset() {
+        violations.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif // ALLOC_GUARD_H
@@ -1,13 +1,22 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstdint>
+#include <cstring>
+#include <concepts>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
+#if __has_include(<drv_common.h>) // 主机上的打包工具等也使用此头文件
 #include <drv_common.h>
+#endif
 #include <dirent.h>
+#include "alloc_guard.hpp"
+#include "fixed_string.hpp"
 
 class AudioBase {
 public:
@@ -15,122 +24,145 @@ public:
     uint32_t byte_rate{};
     uint8_t num_channels{};
     uint8_t bit_depth{};
-    uint16_t samples_start_index{};
-    uint32_t samples_current_index{};
-    uint32_t data_size{};
-    std::string name;
+    // 文件偏移与数据长度均为64位，支持RF64/BW64的超过4GB的录音
+    uint64_t samples_start_index{};
+    uint64_t samples_current_index{};
+    uint64_t data_size{};
+    PathString name; // 定长存储，加载歌曲时不申请堆内存
 
     virtual int8_t load(std::string_view name) = 0;
     virtual bool is_valid() const = 0;
-    virtual uint16_t current_time() const {
-        return (samples_current_index - samples_start_index) / byte_rate;
+    // 关闭文件，之后is_valid()为false，需重新load()
+    virtual void close() {}
+    // 以秒为单位的时间
+    virtual uint32_t current_time() const {
+        return tell_frame() / std::max<uint32_t>(sample_rate, 1);
     }
-    virtual uint16_t total_time() const {
-        return data_size / byte_rate;
+    virtual uint32_t total_time() const {
+        return total_frames() / std::max<uint32_t>(sample_rate, 1);
     }
-    virtual void seek_to(uint16_t time) = 0;
+    void seek_to(uint32_t time) {
+        seek_frame(uint64_t(time) * sample_rate);
+    }
+    // 以帧为单位的读取位置（相对数据块开头），跳转与暂停回退均以帧为单位
+    uint16_t block_align() const {
+        return bit_depth / 8 * num_channels;
+    }
+    uint64_t total_frames() const {
+        const uint16_t align = block_align();
+        return align ? data_size / align : 0;
+    }
+    virtual uint64_t tell_frame() const {
+        const uint16_t align = block_align();
+        return align ? (samples_current_index - samples_start_index) / align : 0;
+    }
+    virtual void seek_frame(uint64_t frame) = 0;
     virtual unsigned read(uint8_t buffer[], unsigned size) = 0;
+    // 零拷贝读取：返回接下来最多size字节数据的只读视图并前移读取位置，
+    // 视图在下一次读取、跳转或加载之前有效。supports_view()为false时调用方使用read()
+    virtual bool supports_view() const {
+        return false;
+    }
+    virtual std::span<const uint8_t> view(unsigned) {
+        return {};
+    }
     virtual ~AudioBase() = default;
-};
-
-class Audio : public AudioBase {
-    enum class Endianness {
-        LittleEndian,
-        BigEndian
-    };
-    static inline int32_t four_bytes_to_int(std::string_view source, Endianness endianness = Endianness::LittleEndian) {
-        if (endianness == Endianness::LittleEndian)
-            return (static_cast<int32_t>(source[0]) |
-                    (static_cast<int32_t>(source[1]) << 8) |
-                    (static_cast<int32_t>(source[2]) << 16) |
-                    (static_cast<int32_t>(source[3]) << 24));
-        else
-            return (static_cast<int32_t>(source[3]) |
-                    (static_cast<int32_t>(source[2]) << 8) |
-                    (static_cast<int32_t>(source[1]) << 16) |
-                    (static_cast<int32_t>(source[0]) << 24));
-    }
-    static inline int16_t two_bytes_to_int(std::string_view source, Endianness endianness = Endianness::LittleEndian) {
-        if (endianness == Endianness::LittleEndian)
-            return (static_cast<int16_t>(source[0]) |
-                    (static_cast<int16_t>(source[1]) << 8));
-        else
-            return (static_cast<int16_t>(source[1]) |
-                    (static_cast<int16_t>(source[0]) << 8));
+protected:
+    static uint32_t le32(const uint8_t* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
     }
-
-    int16_t get_index_of_chunk(std::string_view id, uint16_t start_index = 0) {
-        constexpr uint8_t data_len = 4;
-        constexpr uint16_t header_max_len = 32767; // 假设这是最大长度
-
-        if (id.size() != data_len)
-            return -1;
-
-        std::string buf;
-        buf.resize(data_len);
-        int16_t i = start_index;
-        while (i < header_max_len - data_len) {
-            fseek(file, i, SEEK_SET);
-            fread(buf.data(), sizeof *buf.data(), data_len, file);
-            if (buf == id)
-                return i;
-
-            i += data_len;
-
-            fread(buf.data(), sizeof *buf.data(), data_len, file);
-            int32_t chunk_size = four_bytes_to_int(buf);
-            if (chunk_size > header_max_len - i - data_len)
+    static uint16_t le16(const uint8_t* p) {
+        return p[0] | (p[1] << 8);
+    }
+    static uint64_t le64(const uint8_t* p) {
+        return le32(p) | (uint64_t(le32(p + 4)) << 32);
+    }
+    // 解析RIFF/WAVE头并填写格式字段，同时支持RF64/BW64（长度记录在ds64块中）
+    // 逐块查找fmt与data，不限制数据块之前元数据块的长度
+    // read_at(offset, dst, n)从文件offset处读取n字节，成功返回true
+    template<typename ReadAt>
+    bool parse_wav(ReadAt&& read_at, uint64_t file_size) {
+        uint8_t b[28];
+        if (file_size < 12 || !read_at(0, b, 12) || std::memcmp(b + 8, "WAVE", 4) != 0)
+            return false;
+        const bool rf64 = std::memcmp(b, "RF64", 4) == 0 || std::memcmp(b, "BW64", 4) == 0;
+        if (!rf64 && std::memcmp(b, "RIFF", 4) != 0)
+            return false;
+        uint64_t fmt = 0, data = 0, data_len = 0, ds64_data_len = 0;
+        for (uint64_t i = 12; i + 8 <= file_size && !(fmt && data);) {
+            if (!read_at(i, b, 8))
+                return false;
+            const uint64_t len = le32(b + 4);
+            if (std::memcmp(b, "fmt ", 4) == 0) {
+                fmt = i;
+            } else if (std::memcmp(b, "data", 4) == 0) {
+                data = i, data_len = len;
+            } else if (rf64 && std::memcmp(b, "ds64", 4) == 0) {
+                // riffSize u64, dataSize u64, sampleCount u64, ...
+                if (len < 24 || !read_at(i + 8, b, 24))
+                    return false;
+                ds64_data_len = le64(b + 8);
+            }
+            if (data)
+                break; // 数据块之后不再查找，避免对大文件逐块跳转
+            if (len > file_size - i - 8)
                 break;
-            i += chunk_size + data_len; // 跳过当前块
+            i += 8 + len + (len & 1); // 块按偶数字节对齐
         }
-        return -1;
+        if (!fmt || !data || !read_at(fmt + 8, b, 16))
+            return false;
+        if (rf64 && data_len == UINT32_MAX)
+            data_len = ds64_data_len;
+        num_channels = le16(b + 2);
+        sample_rate = le32(b + 4);
+        bit_depth = le16(b + 14);
+        byte_rate = bit_depth / 8 * sample_rate * num_channels;
+        samples_start_index = data + 8;
+        samples_current_index = samples_start_index;
+        data_size = std::min(data_len, file_size - samples_start_index);
+        return byte_rate != 0;
     }
+};
+
+// 播放器可使用的音频源
+template<typename T>
+concept AudioSourceType = std::derived_from<T, AudioBase> && std::default_initializable<T>;
+
+class Audio : public AudioBase {
     FILE* file{};
+    char stdio_buf[512]; // stdio缓冲区放在对象内，切歌时不由stdio申请
 public:
     Audio() = default;
     Audio(std::string_view name) {
         load(name);
     }
+    // 偏移经过fseek/ftell，受long的范围限制（32位平台上为2GB）；更大的文件可改用fseeko等64位接口
     int8_t load(std::string_view name) override {
         // 先关闭已打开的文件
-        if (is_valid()) {
-            fclose(file);
-            file = nullptr;
-        }
+        close();
+        if (name.size() > PathString::capacity())
+            return -1; // 路径过长
         
-        if (!(file = fopen(name.data(), "rb")))
+        {
+            AllocGuard::Allow allow; // 文件系统为打开的文件申请内存，切歌时不可避免
+            file = fopen(name.data(), "rb");
+        }
+        if (!file)
             return -1; // 打开文件失败
-
-        std::string buf;
-        buf.resize(4);
-
-        fread(buf.data(), sizeof *buf.data(), buf.size(), file);
-        if (buf != "RIFF")
+        setvbuf(file, stdio_buf, _IOFBF, sizeof stdio_buf);
+
+        fseek(file, 0, SEEK_END);
+        const long file_size = ftell(file);
+        auto read_at = [this](uint64_t offset, uint8_t* dst, size_t n) {
+            return offset <= uint64_t(LONG_MAX) && fseek(file, long(offset), SEEK_SET) == 0
+                && fread(dst, 1, n, file) == n;
+        };
+        if (file_size <= 0 || !parse_wav(read_at, uint64_t(file_size))) {
+            close();
             return -1;
-
-        fseek(file, 8, SEEK_SET); // 跳过RIFF大小字段
-        fread(buf.data(), sizeof *buf.data(), buf.size(), file);
-        if (buf != "WAVE")
-            return -1;
-        
-        const int16_t fmt_chunk_index = get_index_of_chunk("fmt ", 12), data_chunk_index = get_index_of_chunk("data", 12);
-        if (fmt_chunk_index == -1 || data_chunk_index == -1)
-            return -1;
-        // 可以添加更多的检查
-        // 读取 data chunk
-        buf.resize(16); // fmt chunk size is usually 16 bytes
-        fseek(file, data_chunk_index + 4, SEEK_SET);
-        fread(buf.data(), sizeof *buf.data(), 4, file);
-        data_size = four_bytes_to_int(buf);
-        samples_start_index = data_chunk_index + 8;
-        // 读取 fmt chunk
-        fseek(file, fmt_chunk_index + 8, SEEK_SET);
-        fread(buf.data(), sizeof *buf.data(), buf.size(), file);
-        // uint16_t audio_format = two_bytes_to_int(buf.substr(0, 2));
-        num_channels = two_bytes_to_int(buf.substr(2, 2));
-        sample_rate = four_bytes_to_int(buf.substr(4, 4));
-        bit_depth = two_bytes_to_int(buf.substr(14, 2));
-        byte_rate = bit_depth / 8 * sample_rate * num_channels;
+        }
+        fseek(file, long(samples_start_index), SEEK_SET);
+        samples_current_index = samples_start_index;
 
         this->name = name;
 
@@ -139,20 +171,27 @@ public:
     bool is_valid() const override {
         return file != nullptr;
     }
-    uint16_t current_time() const override {
-        return (ftell(file) - samples_start_index) / byte_rate;
+    void close() override {
+        if (is_valid())
+            fclose(file);
+        file = nullptr;
     }
-    void seek_to(uint16_t time) override {
-        fseek(file, samples_start_index + time * byte_rate, SEEK_SET);
+    // 读取位置记录在samples_current_index中，不必每次调用ftell
+    void seek_frame(uint64_t frame) override {
+        samples_current_index = samples_start_index + std::min(frame * block_align(), data_size);
+        fseek(file, long(samples_current_index), SEEK_SET);
     }
+    // 不读到数据块之后的LIST等块
     unsigned read(uint8_t buffer[], unsigned size) override {
-        return fread(buffer, sizeof *buffer, size, file);
+        const uint64_t end = samples_start_index + data_size;
+        if (samples_current_index >= end)
+            return 0;
+        const unsigned n = fread(buffer, sizeof *buffer, std::min<uint64_t>(size, end - samples_current_index), file);
+        samples_current_index += n;
+        return n;
     }
     ~Audio() {
-        if (is_valid()) {
-            fclose(file);
-            file = nullptr;
-        }
+        close();
     }
 
     static std::vector<std::string> scan_directory(std::string_view path) {
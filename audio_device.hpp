@@ -1,29 +1,33 @@
 #ifndef AUDIO_DEVICE_H
 #define AUDIO_DEVICE_H
 
+#include <atomic>
+#include <concepts>
 #include <cstdint>
 #include <functional>
+#include <optional>
 #include "volume.hpp"
+#include "trace.hpp"
 
-class AudioDevice {
+// 设备公共部分：音量与循环模式DMA状态
+class AudioDeviceBase {
+public:
+    // 硬件音量：编解码器内部的数字音量寄存器，寄存器值0对应min_db，每级step_db
+    struct HardwareGain {
+        float min_db;
+        float max_db;
+        float step_db;
+        float ramp_db = 3.0f; // 每个缓冲区最多调整的增益，避免寄存器跳变产生咔哒声
+    };
+private:
     bool cir_mode{}; // 是否使用循环模式
+    std::atomic<uint32_t> dma_seq{}; // 循环模式下已播放完毕的半区序号，奇数为前半区，偶数为后半区
+    std::optional<HardwareGain> hw_gain;
 public:
     Volume volume;
-    std::function<void()> sem_acquire = [] {}; // 获取信号量
-    std::function<void(uint8_t)> sem_reset = [](uint8_t n) {}; // 重置信号量
-    std::function<void(int16_t*, uint16_t)> transmit = [](int16_t*, uint16_t) {}; // 音频传输
-    std::function<void()> transmit_stop = [] {}; // 停止传输
-    std::function<void(uint32_t, uint8_t, uint8_t)> format_set = [](uint32_t, uint8_t, uint8_t) {}; // 设置音频格式
-    
-    AudioDevice(
-        decltype(sem_acquire) sem_acquire = [] {},
-        decltype(sem_reset) sem_reset = [](uint8_t n) {},
-        decltype(transmit) audio_transmit = [](int16_t*, uint16_t) {},
-        decltype(transmit_stop) audio_transmit_stop = [] {},
-        decltype(format_set) format_set = [](uint32_t, uint8_t, uint8_t) {},
-        bool circular_mode = false
-    ) : sem_acquire(sem_acquire), sem_reset(sem_reset), transmit(audio_transmit), transmit_stop(audio_transmit_stop), format_set(format_set), cir_mode(circular_mode) {}
-    
+
+    AudioDeviceBase(bool circular_mode = false) : cir_mode(circular_mode) {}
+
     void set_volume(uint8_t vol) {
         volume.set(vol);
     }
@@ -37,6 +41,68 @@ public:
     bool is_circular_mode() const {
         return cir_mode;
     }
+
+    // 声明设备支持硬件音量，设备还需提供gain_set(int32_t 寄存器值)
+    // 启用后播放器不再逐采样施加音量，只在超出寄存器范围时由软件补足
+    void set_hardware_gain(std::optional<HardwareGain> gain) {
+        hw_gain = gain;
+    }
+    const std::optional<HardwareGain>& hardware_gain() const {
+        return hw_gain;
+    }
+
+    // 以下三个函数供循环模式使用，on_dma_* 需在对应的DMA中断回调中调用
+    void on_dma_half_complete() { dma_event(0); }
+    void on_dma_complete() { dma_event(1); }
+    void dma_reset() {
+        dma_seq.store(0, std::memory_order_relaxed);
+    }
+    uint32_t dma_sequence() const {
+        return dma_seq.load(std::memory_order_acquire);
+    }
+private:
+    void dma_event(uint8_t half) {
+        // 序号的奇偶性与刚播放完的半区对应，即使丢失一次中断也能保持一致
+        uint32_t next = dma_seq.load(std::memory_order_relaxed) + 1;
+        if ((next & 1) != (half == 0))
+            ++next;
+        dma_seq.store(next, std::memory_order_release);
+        Trace::irq_instant(half ? "dma_complete" : "dma_half");
+    }
+};
+
+// 设备接口：派生自AudioDeviceBase，并提供以下成员函数（或可调用成员）
+// 直接以成员函数实现时调用可被内联，无需经过std::function
+// 支持硬件音量的设备另外提供gain_set(int32_t)，并调用set_hardware_gain()声明范围
+// 非循环模式下使用poll()的设备另外提供bool sem_try_acquire()
+template<typename T>
+concept AudioDeviceType = std::derived_from<T, AudioDeviceBase> && requires(T& dev, int16_t* data, uint16_t size) {
+    dev.sem_acquire();
+    dev.sem_reset(uint8_t{});
+    dev.transmit(data, size);
+    dev.transmit_stop();
+    dev.format_set(uint32_t{}, uint8_t{}, uint8_t{});
+};
+
+// 运行时传入回调的设备（类型擦除）
+class AudioDevice : public AudioDeviceBase {
+public:
+    std::function<void()> sem_acquire = [] {}; // 获取信号量
+    std::function<bool()> sem_try_acquire = [] { return false; }; // 非阻塞获取信号量，非循环模式下使用poll()时需设置
+    std::function<void(uint8_t)> sem_reset = [](uint8_t n) {}; // 重置信号量
+    std::function<void(int16_t*, uint16_t)> transmit = [](int16_t*, uint16_t) {}; // 音频传输
+    std::function<void()> transmit_stop = [] {}; // 停止传输
+    std::function<void(uint32_t, uint8_t, uint8_t)> format_set = [](uint32_t, uint8_t, uint8_t) {}; // 设置音频格式
+    std::function<void(int32_t)> gain_set = [](int32_t) {}; // 设置硬件音量寄存器，需配合set_hardware_gain()
+    
+    AudioDevice(
+        decltype(sem_acquire) sem_acquire = [] {},
+        decltype(sem_reset) sem_reset = [](uint8_t n) {},
+        decltype(transmit) audio_transmit = [](int16_t*, uint16_t) {},
+        decltype(transmit_stop) audio_transmit_stop = [] {},
+        decltype(format_set) format_set = [](uint32_t, uint8_t, uint8_t) {},
+        bool circular_mode = false
+    ) : AudioDeviceBase(circular_mode), sem_acquire(sem_acquire), sem_reset(sem_reset), transmit(audio_transmit), transmit_stop(audio_transmit_stop), format_set(format_set) {}
 };
 
 #endif
@@ -0,0 +1,259 @@
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <span>
+#include "triple_buffer.hpp"
+
+// 参数均衡器：定点双二阶滤波器级联，每个声道可使用不同系数
+// 系数由控制侧（UI线程）计算后经三缓冲交给播放线程，播放线程不加锁
+// 采样率由播放线程在切歌时设置，自行按最近一份配置重新计算系数，也不经过控制侧的锁
+// 提升频段会使满幅信号超出int16：级联内部留有余量，输出端按整条曲线的最大增益衰减（前级增益），
+// 满幅正弦在任何频率都不会被削波
+class Equalizer {
+public:
+    static constexpr uint8_t max_bands = 6;
+    static constexpr uint8_t max_channels = 2;
+
+    enum class FilterType : uint8_t {
+        PEAK,           // 峰值
+        LOW_SHELF,      // 低频搁架
+        HIGH_SHELF      // 高频搁架
+    };
+    struct Band {
+        FilterType type;
+        float freq;     // 中心/转折频率 Hz
+        float gain_db;
+        float q;
+    };
+    enum class Preset : uint8_t {
+        FLAT,
+        BASS,
+        TREBLE,
+        VOCAL,
+        SMALL_SPEAKER   // 小喇叭：切除难以重放的超低频并补偿中低频
+    };
+
+private:
+    // 系数为Q28格式（范围±8，可容纳较大增益的搁架滤波器），信号为Q27，比int16多出24dB余量
+    static constexpr int coeff_shift = 28;
+    static constexpr int signal_shift = 12;
+    static constexpr int makeup_shift = 15;
+    struct Biquad {
+        int32_t b0, b1, b2, a1, a2;
+    };
+    // 设计结果，已除以a0
+    struct Design {
+        double b0, b1, b2, a1, a2;
+    };
+    using Config = std::array<std::array<Band, max_bands>, max_channels>;
+    // 连同配置一起发布，采样率与设计时不同的系数由播放线程按配置重新计算
+    struct Coeffs {
+        std::array<std::array<Biquad, max_bands>, max_channels> ch;
+        uint8_t bands;
+        int32_t makeup; // 输出增益，Q15，不大于1
+        uint32_t rate;  // 设计时的采样率
+        Config config;
+    };
+    struct State {
+        int32_t x1, x2, y1, y2;
+    };
+
+    // 控制侧
+    std::mutex config_mutex;
+    Config config{};
+    uint8_t config_bands{};
+    std::atomic<uint32_t> sample_rate{44100}; // 播放线程最近设置的采样率，控制侧按此设计
+    TripleBuffer<Coeffs> coeffs;
+
+    // 播放线程
+    Coeffs active{}; // 正在使用的系数
+    uint32_t play_rate{44100};
+    std::array<std::array<State, max_bands>, max_channels> state{};
+
+    static Design design(const Band& band, uint32_t rate) {
+        const double A = std::pow(10.0, band.gain_db / 40.0);
+        const double w0 = 2 * std::numbers::pi * std::clamp<double>(band.freq, 10.0, rate * 0.45) / rate;
+        const double cos_w0 = std::cos(w0);
+        const double alpha = std::sin(w0) / (2 * std::max(band.q, 0.1f));
+        const double sqrt_A2 = 2 * std::sqrt(A) * alpha;
+        double b0, b1, b2, a0, a1, a2;
+        switch (band.type) {
+            case FilterType::LOW_SHELF:
+                b0 = A * ((A + 1) - (A - 1) * cos_w0 + sqrt_A2);
+                b1 = 2 * A * ((A - 1) - (A + 1) * cos_w0);
+                b2 = A * ((A + 1) - (A - 1) * cos_w0 - sqrt_A2);
+                a0 = (A + 1) + (A - 1) * cos_w0 + sqrt_A2;
+                a1 = -2 * ((A - 1) + (A + 1) * cos_w0);
+                a2 = (A + 1) + (A - 1) * cos_w0 - sqrt_A2;
+                break;
+            case FilterType::HIGH_SHELF:
+                b0 = A * ((A + 1) + (A - 1) * cos_w0 + sqrt_A2);
+                b1 = -2 * A * ((A - 1) + (A + 1) * cos_w0);
+                b2 = A * ((A + 1) + (A - 1) * cos_w0 - sqrt_A2);
+                a0 = (A + 1) - (A - 1) * cos_w0 + sqrt_A2;
+                a1 = 2 * ((A - 1) - (A + 1) * cos_w0);
+                a2 = (A + 1) - (A - 1) * cos_w0 - sqrt_A2;
+                break;
+            default:
+                b0 = 1 + alpha * A;
+                b1 = -2 * cos_w0;
+                b2 = 1 - alpha * A;
+                a0 = 1 + alpha / A;
+                a1 = -2 * cos_w0;
+                a2 = 1 - alpha / A;
+                break;
+        }
+        return {b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+    }
+    static Biquad quantize(const Design& d) {
+        auto q = [](double c) {
+            return static_cast<int32_t>(std::lround(c * (1 << coeff_shift)));
+        };
+        return {q(d.b0), q(d.b1), q(d.b2), q(d.a1), q(d.a2)};
+    }
+    // 角频率w处的幅度响应
+    static double magnitude(const Design& d, double w) {
+        const auto z1 = std::polar(1.0, -w), z2 = z1 * z1;
+        return std::abs((d.b0 + d.b1 * z1 + d.b2 * z2) / (1.0 + d.a1 * z1 + d.a2 * z2));
+    }
+    // 按c.config与c.bands为rate计算系数
+    // 前级增益取各声道级联响应在20Hz到0.45倍采样率（对数分布，另加各频段中心频率）上的最大值的倒数
+    static void design_all(Coeffs& c, uint32_t rate) {
+        c.rate = rate;
+        std::array<std::array<Design, max_bands>, max_channels> d;
+        for (uint8_t ch = 0; ch < max_channels; ++ch)
+            for (uint8_t i = 0; i < c.bands; ++i)
+                c.ch[ch][i] = quantize(d[ch][i] = design(c.config[ch][i], rate));
+
+        constexpr uint8_t grid = 128;
+        const double lo = 20.0, hi = rate * 0.45;
+        double peak = 1.0;
+        auto check = [&](double freq) {
+            const double w = 2 * std::numbers::pi * std::clamp(freq, lo, hi) / rate;
+            for (uint8_t ch = 0; ch < max_channels; ++ch) {
+                double g = 1.0;
+                for (uint8_t i = 0; i < c.bands; ++i)
+                    g *= magnitude(d[ch][i], w);
+                peak = std::max(peak, g);
+            }
+        };
+        for (uint8_t k = 0; k < grid && c.bands; ++k)
+            check(lo * std::pow(hi / lo, k / (grid - 1.0)));
+        for (uint8_t ch = 0; ch < max_channels; ++ch)
+            for (uint8_t i = 0; i < c.bands; ++i)
+                check(c.config[ch][i].freq);
+        c.makeup = static_cast<int32_t>((1 << makeup_shift) / peak);
+    }
+    // 根据当前配置重新计算系数并发布，调用者需持有config_mutex
+    void publish() {
+        auto& c = coeffs.write_buffer();
+        c.bands = config_bands;
+        c.config = config;
+        design_all(c, sample_rate.load(std::memory_order_relaxed));
+        coeffs.publish();
+    }
+    // 取得控制侧最新的系数，采样率不符时重新计算
+    void refresh(bool force) {
+        if (coeffs.update()) {
+            active = coeffs.read_buffer();
+            force = true;
+        }
+        if (force && active.rate != play_rate)
+            design_all(active, play_rate);
+    }
+    static int32_t saturate(int64_t v) {
+        return static_cast<int32_t>(std::clamp<int64_t>(v, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+    }
+
+public:
+    // 设置频段，channel为-1时应用到所有声道
+    void set_bands(std::span<const Band> bands, int8_t channel = -1) {
+        std::lock_guard config_lk(config_mutex);
+        const uint8_t n = std::min<size_t>(bands.size(), max_bands);
+        for (uint8_t ch = 0; ch < max_channels; ++ch) {
+            if (channel >= 0 && channel != ch)
+                continue;
+            std::ranges::copy(bands.first(n), config[ch].begin());
+            // 频段数较少的声道用直通滤波器补齐
+            std::fill(config[ch].begin() + n, config[ch].end(), Band{FilterType::PEAK, 1000, 0, 1});
+        }
+        config_bands = std::max(n, channel >= 0 ? config_bands : uint8_t{0});
+        publish();
+    }
+    void set_preset(Preset preset) {
+        static constexpr Band bass[] = {
+            {FilterType::LOW_SHELF, 120, 6, 0.7f}
+        };
+        static constexpr Band treble[] = {
+            {FilterType::HIGH_SHELF, 6000, 5, 0.7f}
+        };
+        static constexpr Band vocal[] = {
+            {FilterType::LOW_SHELF, 150, -3, 0.7f},
+            {FilterType::PEAK, 2500, 4, 1.0f}
+        };
+        static constexpr Band small_speaker[] = {
+            {FilterType::LOW_SHELF, 80, -9, 0.7f},
+            {FilterType::PEAK, 250, 4, 0.9f},
+            {FilterType::PEAK, 3500, -2, 1.5f}
+        };
+        switch (preset) {
+            case Preset::FLAT: set_bands({}); break;
+            case Preset::BASS: set_bands(bass); break;
+            case Preset::TREBLE: set_bands(treble); break;
+            case Preset::VOCAL: set_bands(vocal); break;
+            case Preset::SMALL_SPEAKER: set_bands(small_speaker); break;
+        }
+    }
+    // 以下只在播放线程中调用
+    // 采样率变化时按最近一份配置重新计算系数，不等待控制侧
+    void set_sample_rate(uint32_t rate) {
+        if (rate == 0 || rate == play_rate)
+            return;
+        play_rate = rate;
+        sample_rate.store(rate, std::memory_order_relaxed); // 之后控制侧按新采样率设计
+        refresh(true);
+    }
+    // 每个缓冲区开始时调用，取得最新系数，返回是否需要处理
+    bool begin() {
+        refresh(false);
+        return active.bands != 0;
+    }
+    // 处理一帧（C个声道交织的采样），各声道作为独立通道在同一循环中计算，便于编译器向量化
+    // 输出已乘前级增益，仍为int16范围内的值
+    template<uint8_t C>
+    void process(int32_t (&frame)[C]) {
+        static_assert(C <= max_channels);
+        const auto& c = active;
+        int32_t x[C];
+        for (uint8_t ch = 0; ch < C; ++ch)
+            x[ch] = frame[ch] << signal_shift; // int16 -> Q27
+        for (uint8_t i = 0; i < c.bands; ++i) {
+            for (uint8_t ch = 0; ch < C; ++ch) {
+                const auto& k = c.ch[ch][i];
+                auto& s = state[ch][i];
+                const int64_t acc = static_cast<int64_t>(k.b0) * x[ch] + static_cast<int64_t>(k.b1) * s.x1
+                                  + static_cast<int64_t>(k.b2) * s.x2 - static_cast<int64_t>(k.a1) * s.y1
+                                  - static_cast<int64_t>(k.a2) * s.y2;
+                const int32_t y = saturate(acc >> coeff_shift);
+                s.x2 = s.x1;
+                s.x1 = x[ch];
+                s.y2 = s.y1;
+                s.y1 = y;
+                x[ch] = y;
+            }
+        }
+        for (uint8_t ch = 0; ch < C; ++ch)
+            frame[ch] = static_cast<int32_t>((static_cast<int64_t>(x[ch]) * c.makeup) >> (makeup_shift + signal_shift));
+    }
+};
+
+#endif // EQUALIZER_H
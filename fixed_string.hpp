@@ -0,0 +1,73 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+// 定长字符串：存储在对象内部，赋值和拼接不会申请堆内存，超出容量时返回false且内容不变
+template<size_t N>
+class FixedString {
+    char data_[N + 1]{};
+    size_t size_{};
+public:
+    FixedString() = default;
+    FixedString(std::string_view s) {
+        assign(s);
+    }
+    FixedString& operator=(std::string_view s) {
+        assign(s);
+        return *this;
+    }
+
+    bool assign(std::string_view s) {
+        if (s.size() > N)
+            return false;
+        std::memcpy(data_, s.data(), s.size());
+        size_ = s.size();
+        data_[size_] = '\0';
+        return true;
+    }
+    bool append(std::string_view s) {
+        if (s.size() > N - size_)
+            return false;
+        std::memcpy(data_ + size_, s.data(), s.size());
+        size_ += s.size();
+        data_[size_] = '\0';
+        return true;
+    }
+    void clear() {
+        size_ = 0;
+        data_[0] = '\0';
+    }
+
+    const char* c_str() const {
+        return data_;
+    }
+    const char* data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    static constexpr size_t capacity() {
+        return N;
+    }
+    std::string_view view() const {
+        return {data_, size_};
+    }
+    operator std::string_view() const {
+        return view();
+    }
+    friend bool operator==(const FixedString& a, std::string_view b) {
+        return a.view() == b;
+    }
+};
+
+// 文件路径，FAT长文件名最长255字符
+using PathString = FixedString<255>;
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,256 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <lvgl.h>
+
+// 按需加载的字形缓存：字体放在SD卡上，只把最近用到的字形保存在RAM中（LRU），
+// 找不到的字符交给fallback字体（通常是内置的zh）
+// 接口按LVGL v9.2的lv_font_t回调实现，只能在LVGL线程中使用
+//
+// 字体文件格式（小端）：
+//   文件头16字节：magic "GLF1", line_height u16, base_line i16, bpp u8(1/2/4/8), 保留 u8[3], count u32
+//   索引 count*16字节，按unicode升序排列：
+//     unicode u32, offset u32(位图在文件中的位置), adv_w u16, box_w u8, box_h u8, ofs_x i8, ofs_y i8, size u16(位图字节数)
+//   位图：逐行存放，每行按字节对齐，每像素bpp位，高位在前
+template<size_t Slots = 128, size_t MaxBitmap = 128>
+class GlyphCache {
+    static_assert(Slots > 0 && Slots < 0x7FFF);
+public:
+    static constexpr uint32_t magic = 0x31464C47; // "GLF1"
+
+    struct Stats {
+        uint32_t hits;      // 查找命中次数（布局和绘制各算一次）
+        uint32_t misses;    // 需要读SD卡的次数
+        uint32_t evictions; // 被挤出缓存的字形数
+    };
+private:
+    static constexpr size_t header_size = 16;
+    static constexpr size_t block = 64; // 稀疏索引间隔，一次未命中最多读一块索引
+
+    struct Entry {
+        uint32_t unicode;
+        uint32_t offset;
+        uint16_t adv_w;
+        uint8_t box_w;
+        uint8_t box_h;
+        int8_t ofs_x;
+        int8_t ofs_y;
+        uint16_t size;
+    };
+    static_assert(sizeof(Entry) == 16);
+
+    struct Slot {
+        Entry entry;
+        bool used;
+        bool present;   // false表示字体中没有该字符，避免反复查找
+        int16_t prev, next; // LRU链表
+        int16_t chain;      // 哈希桶链表
+        std::array<uint8_t, MaxBitmap> bitmap;
+    };
+
+    lv_font_t font{};
+    FILE* file{};
+    uint8_t bpp{};
+    uint32_t count{};
+    std::vector<uint32_t> sparse; // 每block个索引项的首个unicode
+    std::array<Entry, block> block_buf{};
+    std::array<Slot, Slots> slots{};
+    std::array<int16_t, Slots> buckets{};
+    int16_t head{-1}, tail{-1};
+    Stats stats{};
+
+    void unlink(int16_t i) {
+        auto& s = slots[i];
+        (s.prev >= 0 ? slots[s.prev].next : head) = s.next;
+        (s.next >= 0 ? slots[s.next].prev : tail) = s.prev;
+    }
+    void push_front(int16_t i) {
+        slots[i].prev = -1;
+        slots[i].next = head;
+        (head >= 0 ? slots[head].prev : tail) = i;
+        head = i;
+    }
+    void unhash(int16_t i) {
+        auto p = &buckets[slots[i].entry.unicode % Slots];
+        while (*p != i)
+            p = &slots[*p].chain;
+        *p = slots[i].chain;
+    }
+    void clear() {
+        buckets.fill(-1);
+        head = tail = -1;
+        for (int16_t i = 0; i < int16_t(Slots); ++i) {
+            slots[i].used = false;
+            push_front(i);
+        }
+        stats = {};
+    }
+
+    // 先在稀疏索引中二分，再读入对应的一块索引二分
+    bool find(uint32_t letter, Entry& out) {
+        if (!file || sparse.empty() || letter < sparse.front())
+            return false;
+        auto b = size_t(std::upper_bound(sparse.begin(), sparse.end(), letter) - sparse.begin() - 1);
+        auto n = std::min<size_t>(block, count - b * block);
+        if (fseek(file, header_size + b * block * sizeof(Entry), SEEK_SET) != 0
+            || fread(block_buf.data(), sizeof(Entry), n, file) != n)
+            return false;
+        auto end = block_buf.begin() + n;
+        auto it = std::lower_bound(block_buf.begin(), end, letter,
+            [](const Entry& e, uint32_t u) { return e.unicode < u; });
+        if (it == end || it->unicode != letter)
+            return false;
+        out = *it;
+        return true;
+    }
+
+    const Slot* lookup(uint32_t letter) {
+        for (auto i = buckets[letter % Slots]; i >= 0; i = slots[i].chain) {
+            if (slots[i].entry.unicode == letter) {
+                ++stats.hits;
+                unlink(i);
+                push_front(i);
+                return slots[i].present ? &slots[i] : nullptr;
+            }
+        }
+        ++stats.misses;
+        auto i = tail;
+        auto& s = slots[i];
+        if (s.used) {
+            unhash(i);
+            ++stats.evictions;
+        }
+        s.present = find(letter, s.entry) && s.entry.size <= MaxBitmap
+            && fseek(file, s.entry.offset, SEEK_SET) == 0
+            && fread(s.bitmap.data(), 1, s.entry.size, file) == s.entry.size;
+        s.entry.unicode = letter;
+        s.used = true;
+        s.chain = buckets[letter % Slots];
+        buckets[letter % Slots] = i;
+        unlink(i);
+        push_front(i);
+        return s.present ? &s : nullptr;
+    }
+
+    static bool get_glyph_dsc(const lv_font_t* f, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t) {
+        auto self = static_cast<GlyphCache*>(f->user_data);
+        auto s = self->lookup(letter);
+        if (!s)
+            return false;
+        dsc->adv_w = s->entry.adv_w;
+        dsc->box_w = s->entry.box_w;
+        dsc->box_h = s->entry.box_h;
+        dsc->ofs_x = s->entry.ofs_x;
+        dsc->ofs_y = s->entry.ofs_y;
+        dsc->format = static_cast<lv_font_glyph_format_t>(self->bpp);
+        dsc->is_placeholder = false;
+        dsc->gid.index = letter;
+        return true;
+    }
+
+    // 展开为A8写入LVGL分配的draw_buf，两次回调之间字形可能被挤出，所以按unicode重新查找
+    static const void* get_glyph_bitmap(lv_font_glyph_dsc_t* dsc, lv_draw_buf_t* draw_buf) {
+        auto self = static_cast<GlyphCache*>(dsc->resolved_font->user_data);
+        auto s = self->lookup(dsc->gid.index);
+        if (!s || !draw_buf)
+            return nullptr;
+        const uint8_t bpp = self->bpp, mask = (1u << bpp) - 1;
+        const uint32_t src_stride = (s->entry.box_w * bpp + 7) / 8;
+        const uint32_t dst_stride = draw_buf->header.stride;
+        for (uint32_t y = 0; y < s->entry.box_h; ++y) {
+            auto src = s->bitmap.data() + y * src_stride;
+            auto dst = draw_buf->data + y * dst_stride;
+            for (uint32_t x = 0, bit = 0; x < s->entry.box_w; ++x, bit += bpp) {
+                uint8_t v = (src[bit / 8] >> (8 - bpp - bit % 8)) & mask;
+                dst[x] = v * 255 / mask;
+            }
+        }
+        return draw_buf;
+    }
+public:
+    GlyphCache() {
+        font.get_glyph_dsc = get_glyph_dsc;
+        font.get_glyph_bitmap = get_glyph_bitmap;
+        font.subpx = LV_FONT_SUBPX_NONE;
+        font.underline_position = -1;
+        font.underline_thickness = 1;
+        font.user_data = this;
+        clear();
+    }
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator=(const GlyphCache&) = delete;
+    ~GlyphCache() {
+        close();
+    }
+
+    // 打开SD卡上的字体文件，失败时所有字符都由fallback显示
+    bool open(const char* path, const lv_font_t* fallback) {
+        close();
+        font.fallback = fallback;
+        if (fallback) {
+            font.line_height = fallback->line_height;
+            font.base_line = fallback->base_line;
+        }
+
+        if (!(file = fopen(path, "rb")))
+            return false;
+        struct {
+            uint32_t magic;
+            uint16_t line_height;
+            int16_t base_line;
+            uint8_t bpp;
+            uint8_t reserved[3];
+            uint32_t count;
+        } header;
+        static_assert(sizeof(header) == header_size);
+        if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != magic
+            || (header.bpp != 1 && header.bpp != 2 && header.bpp != 4 && header.bpp != 8)) {
+            close();
+            return false;
+        }
+        bpp = header.bpp;
+        count = header.count;
+        font.line_height = header.line_height;
+        font.base_line = header.base_line;
+
+        sparse.reserve((count + block - 1) / block);
+        for (uint32_t i = 0; i < count; i += block) {
+            uint32_t unicode;
+            if (fseek(file, header_size + i * sizeof(Entry), SEEK_SET) != 0
+                || fread(&unicode, sizeof(unicode), 1, file) != 1) {
+                close();
+                return false;
+            }
+            sparse.push_back(unicode);
+        }
+        return true;
+    }
+    void close() {
+        if (file)
+            fclose(file);
+        file = nullptr;
+        sparse.clear();
+        count = 0;
+        clear();
+    }
+
+    const lv_font_t* get_font() const {
+        return &font;
+    }
+    Stats get_stats() const {
+        return stats;
+    }
+    // 命中率，百分比
+    uint8_t hit_rate() const {
+        auto total = uint64_t(stats.hits) + stats.misses;
+        return total ? uint8_t(uint64_t(stats.hits) * 100 / total) : 0;
+    }
+};
+
+#endif
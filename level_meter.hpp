@@ -0,0 +1,138 @@
+#ifndef LEVEL_METER_H
+#define LEVEL_METER_H
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <lvgl.h>
+#include "triple_buffer.hpp"
+
+// 峰值/RMS电平表：由增益循环顺带统计，每个缓冲区发布一次，LVGL线程按自己的刷新率绘制
+// 默认关闭，关闭时播放线程不做统计，可以走Volume::apply的快速路径
+class LevelMeter {
+public:
+    static constexpr uint8_t max_channels = 2;
+private:
+    static constexpr uint32_t period = 50; // ms
+    static constexpr float floor_db = -60.0f;
+    static constexpr uint8_t peak_fall = 4, rms_fall = 8; // 没有新数据时每个周期回落的刻度
+
+    struct Levels {
+        std::array<uint16_t, max_channels> peak; // 0-32767
+        std::array<uint16_t, max_channels> rms;
+    };
+    TripleBuffer<Levels> slot;
+    std::atomic<bool> enabled{};
+
+    // 以下只在LVGL线程中访问，数值为0-255的刻度
+    std::array<uint8_t, max_channels> rms{}, peak{}, drawn_rms{}, drawn_peak{};
+    lv_obj_t* area{};
+
+    static uint8_t scale(uint16_t level) {
+        if (level == 0)
+            return 0;
+        const float db = 20.0f * std::log10(level / 32767.0f);
+        return static_cast<uint8_t>(std::clamp((db - floor_db) / -floor_db, 0.0f, 1.0f) * 255);
+    }
+    void channel_area(uint8_t c, uint8_t level, lv_area_t& a) const {
+        lv_area_t content;
+        lv_obj_get_content_coords(area, &content);
+        const int32_t w = lv_area_get_width(&content) / max_channels;
+        a.x1 = content.x1 + c * w;
+        a.x2 = a.x1 + w - 2;
+        a.y2 = content.y2;
+        a.y1 = content.y2 - level * lv_area_get_height(&content) / 255;
+    }
+    static uint8_t fall(uint8_t level, uint8_t step) {
+        return level > step ? level - step : 0;
+    }
+    void update() {
+        if (!is_enabled())
+            return;
+        if (slot.update()) {
+            const auto& levels = slot.read_buffer();
+            for (uint8_t c = 0; c < max_channels; ++c) {
+                rms[c] = scale(levels.rms[c]);
+                peak[c] = std::max<uint8_t>(scale(levels.peak[c]), fall(peak[c], peak_fall)); // 峰值缓慢回落
+            }
+        } else {
+            // 缓冲区比刷新周期长时并非每个周期都有新数据，逐渐回落而不是归零，避免闪烁；停止播放后也会落到底
+            for (uint8_t c = 0; c < max_channels; ++c) {
+                rms[c] = fall(rms[c], rms_fall);
+                peak[c] = fall(peak[c], peak_fall);
+            }
+        }
+        for (uint8_t c = 0; c < max_channels; ++c) {
+            if (rms[c] == drawn_rms[c] && peak[c] == drawn_peak[c])
+                continue;
+            lv_area_t a;
+            channel_area(c, std::max({rms[c], peak[c], drawn_rms[c], drawn_peak[c]}), a);
+            lv_obj_invalidate_area(area, &a);
+            drawn_rms[c] = rms[c];
+            drawn_peak[c] = peak[c];
+        }
+    }
+    void draw(lv_layer_t* layer) const {
+        lv_draw_rect_dsc_t dsc;
+        lv_draw_rect_dsc_init(&dsc);
+        for (uint8_t c = 0; c < max_channels; ++c) {
+            lv_area_t a;
+            channel_area(c, drawn_rms[c], a);
+            dsc.bg_color = lv_color_hex(0x007BFF);
+            if (drawn_rms[c])
+                lv_draw_rect(layer, &dsc, &a);
+            channel_area(c, drawn_peak[c], a);
+            a.y2 = a.y1 + 1;
+            dsc.bg_color = lv_color_hex(0xFF4500);
+            if (drawn_peak[c])
+                lv_draw_rect(layer, &dsc, &a);
+        }
+    }
+public:
+    // LVGL线程：在obj中绘制电平，需持有LVGL锁；开启前obj保持隐藏
+    void attach(lv_obj_t* obj) {
+        area = obj;
+        lv_obj_add_event_cb(area, [](lv_event_t* e) {
+            static_cast<LevelMeter*>(lv_event_get_user_data(e))->draw(lv_event_get_layer(e));
+        }, LV_EVENT_DRAW_MAIN, this);
+        lv_timer_create([](lv_timer_t* t) {
+            static_cast<LevelMeter*>(lv_timer_get_user_data(t))->update();
+        }, period, this);
+        lv_obj_add_flag(area, LV_OBJ_FLAG_HIDDEN);
+    }
+    // LVGL线程：开启或关闭电平表，需持有LVGL锁；关闭时清空读数，下次开启从零开始
+    void set_enabled(bool on) {
+        enabled.store(on, std::memory_order_relaxed);
+        rms.fill(0);
+        peak.fill(0);
+        drawn_rms.fill(0);
+        drawn_peak.fill(0);
+        if (area) {
+            if (on)
+                lv_obj_remove_flag(area, LV_OBJ_FLAG_HIDDEN);
+            else
+                lv_obj_add_flag(area, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+
+    // 任意线程
+    bool is_enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+    // 发布一个缓冲区的统计结果，单声道时两个声道显示相同电平
+    template<size_t C>
+    void publish(const std::array<int32_t, C>& peaks, const std::array<int64_t, C>& sums, size_t frames) {
+        auto& levels = slot.write_buffer();
+        for (uint8_t c = 0; c < max_channels; ++c) {
+            const size_t src = std::min<size_t>(c, C - 1);
+            levels.peak[c] = static_cast<uint16_t>(std::min<int32_t>(peaks[src], 32767));
+            levels.rms[c] = frames ? static_cast<uint16_t>(std::sqrt(static_cast<double>(sums[src]) / frames)) : 0;
+        }
+        slot.publish();
+    }
+};
+
+#endif // LEVEL_METER_H
@@ -2,16 +2,41 @@
 #define LOCK_H
 
 #include <functional>
+#include "trace.hpp"
 
+// 锁策略：任何提供 lock()/unlock() 的类型
+template<typename T>
+concept LockPolicy = requires(T& mutex) {
+    mutex.lock();
+    mutex.unlock();
+};
+
+// 编译期绑定的锁函数，调用可被内联，例如 StaticLock<lv_lock, lv_unlock>
+template<auto Lock, auto Unlock>
+struct StaticLock {
+    void lock() const { Lock(); }
+    void unlock() const { Unlock(); }
+};
+
+// 运行时传入的锁函数（类型擦除）
+struct FunctionLock {
+    std::function<void()> lock = [] {};
+    std::function<void()> unlock = [] {};
+};
+
+template<LockPolicy Lock>
 class ScopedLock {
 public:
-    ScopedLock(std::function<void()> lock, std::function<void()> unlock) 
-        : unlock_(unlock) {
-        lock();
+    explicit ScopedLock(Lock& mutex) : mutex_(mutex) {
+        Trace::begin("lock_wait");
+        mutex_.lock();
+        Trace::end("lock_wait");
     }
-    ~ScopedLock() { unlock_(); }
+    ~ScopedLock() { mutex_.unlock(); }
+    ScopedLock(const ScopedLock&) = delete;
+    ScopedLock& operator=(const ScopedLock&) = delete;
 private:
-    std::function<void()> unlock_;
+    Lock& mutex_;
 };
 
 #endif // LOCK_H
@@ -0,0 +1,145 @@
+#ifndef LOUDNESS_H
+#define LOUDNESS_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <numbers>
+
+// EBU R128 / ITU-R BS.1770 积分响度与采样峰值
+// 400ms块、75%重叠，绝对门限-70 LUFS，相对门限-10 LU；块响度以0.1 LU直方图保存，内存占用与曲目时长无关
+class LoudnessMeter {
+public:
+    static constexpr uint8_t max_channels = 2;
+    static constexpr float min_lufs = -70.0f;
+private:
+    static constexpr float max_lufs = 5.0f;
+    static constexpr float bin_width = 0.1f;
+    static constexpr size_t bins = static_cast<size_t>((max_lufs - min_lufs) / bin_width);
+
+    // 直接II型转置双二阶滤波器
+    struct Filter {
+        float b0{1}, b1{}, b2{}, a1{}, a2{};
+        float z1{}, z2{};
+        float process(float x) {
+            const float y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+    // K加权：高频搁架 + RLB高通，按采样率计算系数
+    std::array<std::array<Filter, 2>, max_channels> k_filter{};
+    std::array<uint32_t, bins> histogram{};
+    std::array<double, 4> sub_energy{}; // 最近4个100ms子块的能量
+    double acc{};
+    uint32_t sub_len{}, sub_pos{}, sub_count{};
+    uint8_t channels{}; // 参与计算的声道数，不超过max_channels
+    uint8_t stride{};   // 输入每帧的声道数，多出的声道不参与计算
+    float peak{};
+
+    static float bin_lufs(size_t i) {
+        return min_lufs + (i + 0.5f) * bin_width;
+    }
+    static double lufs_to_energy(double lufs) {
+        return std::pow(10.0, (lufs + 0.691) / 10.0);
+    }
+    static double energy_to_lufs(double energy) {
+        return -0.691 + 10.0 * std::log10(energy);
+    }
+public:
+    void reset(uint32_t sample_rate, uint8_t num_channels) {
+        stride = std::max<uint8_t>(num_channels, 1);
+        channels = std::min(stride, max_channels);
+        sub_len = std::max<uint32_t>(sample_rate / 10, 1);
+        sub_pos = sub_count = 0;
+        acc = 0;
+        peak = 0;
+        histogram.fill(0);
+        sub_energy.fill(0);
+
+        const double fs = sample_rate;
+        Filter pre, rlb;
+        {
+            const double f0 = 1681.974450955533, G = 3.999843853973347, Q = 0.7071752369554196;
+            const double K = std::tan(std::numbers::pi * f0 / fs);
+            const double Vh = std::pow(10.0, G / 20.0), Vb = std::pow(Vh, 0.4996667741545416);
+            const double a0 = 1.0 + K / Q + K * K;
+            pre.b0 = (Vh + Vb * K / Q + K * K) / a0;
+            pre.b1 = 2.0 * (K * K - Vh) / a0;
+            pre.b2 = (Vh - Vb * K / Q + K * K) / a0;
+            pre.a1 = 2.0 * (K * K - 1.0) / a0;
+            pre.a2 = (1.0 - K / Q + K * K) / a0;
+        }
+        {
+            const double f0 = 38.13547087602444, Q = 0.5003270373238773;
+            const double K = std::tan(std::numbers::pi * f0 / fs);
+            const double a0 = 1.0 + K / Q + K * K;
+            rlb.b0 = 1.0;
+            rlb.b1 = -2.0;
+            rlb.b2 = 1.0;
+            rlb.a1 = 2.0 * (K * K - 1.0) / a0;
+            rlb.a2 = (1.0 - K / Q + K * K) / a0;
+        }
+        for (auto& f : k_filter)
+            f = {pre, rlb};
+    }
+    // samples为交织的PCM，每帧为reset()时给出的声道数，frames为帧数
+    void process(const int16_t* samples, size_t frames) {
+        for (size_t i = 0; i < frames; ++i) {
+            for (uint8_t c = 0; c < channels; ++c) {
+                const float x = samples[i * stride + c] / 32768.0f;
+                peak = std::max(peak, std::abs(x));
+                const float y = k_filter[c][1].process(k_filter[c][0].process(x));
+                acc += y * y;
+            }
+            if (++sub_pos < sub_len)
+                continue;
+            sub_energy[sub_count++ % sub_energy.size()] = acc / sub_len;
+            acc = 0;
+            sub_pos = 0;
+            if (sub_count < sub_energy.size())
+                continue;
+            // 每100ms得到一个400ms块
+            double block = 0;
+            for (double e : sub_energy)
+                block += e;
+            block /= sub_energy.size();
+            if (block <= 0)
+                continue;
+            const double lufs = energy_to_lufs(block);
+            if (lufs < min_lufs)
+                continue;
+            ++histogram[std::min<size_t>((lufs - min_lufs) / bin_width, bins - 1)];
+        }
+    }
+    // 积分响度（LUFS），没有超过绝对门限的块时返回min_lufs
+    float integrated() const {
+        double energy = 0;
+        uint64_t count = 0;
+        for (size_t i = 0; i < bins; ++i) {
+            energy += histogram[i] * lufs_to_energy(bin_lufs(i));
+            count += histogram[i];
+        }
+        if (count == 0)
+            return min_lufs;
+        const double relative_gate = energy_to_lufs(energy / count) - 10.0;
+        energy = 0;
+        count = 0;
+        for (size_t i = 0; i < bins; ++i) {
+            if (bin_lufs(i) < relative_gate)
+                continue;
+            energy += histogram[i] * lufs_to_energy(bin_lufs(i));
+            count += histogram[i];
+        }
+        return count ? energy_to_lufs(energy / count) : min_lufs;
+    }
+    // 采样峰值，满幅为1
+    float sample_peak() const {
+        return peak;
+    }
+};
+
+#endif // LOUDNESS_H
@@ -0,0 +1,105 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <span>
+
+// 软件混音：将预加载在内存中的短音（按键音、定时提醒等）叠加到音乐上
+// 触发请求带时间戳，播放线程每个缓冲区取一次请求，两次之间最多相隔两个半区；
+// 在此之外再等待超过max_delay_ms仍未被处理的请求丢弃：暂停期间按下的按键音不会在恢复播放时补放
+// 触发到出声的延迟为一至两个半区，半区越短（见PeriodTuner）越低
+class Mixer {
+public:
+    static constexpr uint8_t max_voices = 4;
+    static constexpr uint32_t max_delay_ms = 200;
+private:
+    struct Voice {
+        std::span<const int16_t> pcm; // 单声道PCM，采样率与音乐相同
+        int32_t gain{}; // Q15
+        size_t pos{}; // 以下两项只在播放线程中访问
+        bool playing{};
+        std::atomic<uint32_t> start_request{}; // 触发时刻（毫秒，最低位置1），0为无请求
+        std::atomic<bool> stop_request{};
+    };
+    std::array<Voice, max_voices> voices;
+    std::atomic<uint8_t> pending{}; // 尚未处理的触发请求数，用于快速判断是否需要混音
+    uint8_t playing_count{};
+
+    static uint32_t now_ms() {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 处理其他线程的触发/停止请求，只在播放线程中调用；等待超过expire_ms的触发请求丢弃
+    void update(uint32_t expire_ms) {
+        if (pending.load(std::memory_order_acquire) == 0)
+            return;
+        const uint32_t now = now_ms();
+        for (auto& v : voices) {
+            if (v.stop_request.exchange(false, std::memory_order_acq_rel)) {
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                if (v.playing)
+                    --playing_count;
+                v.playing = false;
+            }
+            if (const uint32_t requested = v.start_request.exchange(0, std::memory_order_acq_rel)) {
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                if (int32_t(now - requested) > int32_t(expire_ms)) // 触发时刻的最低位置1后可能比now晚1ms
+                    continue; // 请求时未在播放或已等待过久，过时的短音不再播放
+                if (!v.playing)
+                    ++playing_count;
+                v.playing = true;
+                v.pos = 0;
+            }
+        }
+    }
+public:
+    // 预加载短音，须在播放开始前调用，数据由调用者保证在Mixer生命周期内有效
+    bool load(uint8_t id, std::span<const int16_t> pcm, uint8_t vol = 100) {
+        if (id >= max_voices)
+            return false;
+        voices[id].pcm = pcm;
+        voices[id].gain = std::min<uint8_t>(vol, 100) * 32768 / 100;
+        return true;
+    }
+    // 从头播放，可在任意线程调用；两个半区加max_delay_ms内没有缓冲区被处理（如暂停中）时不播放
+    void trigger(uint8_t id) {
+        if (id >= max_voices || voices[id].pcm.empty())
+            return;
+        if (!voices[id].start_request.exchange(now_ms() | 1, std::memory_order_acq_rel))
+            pending.fetch_add(1, std::memory_order_release);
+    }
+    void stop(uint8_t id) {
+        if (id >= max_voices)
+            return;
+        if (!voices[id].stop_request.exchange(true, std::memory_order_acq_rel))
+            pending.fetch_add(1, std::memory_order_release);
+    }
+    // 以下只在播放线程中调用
+    // 每个缓冲区开始时调用，period_ms为半区时长，返回是否有短音需要混入
+    bool begin(uint32_t period_ms = 0) {
+        update(max_delay_ms + 2 * period_ms);
+        return playing_count != 0;
+    }
+    // 取得下一帧的混合采样，与音乐相加后统一乘音量并饱和
+    int32_t next() {
+        int32_t mix = 0;
+        for (auto& v : voices) {
+            if (!v.playing)
+                continue;
+            mix += (v.pcm[v.pos] * v.gain) >> 15;
+            if (++v.pos == v.pcm.size()) {
+                v.playing = false;
+                --playing_count;
+            }
+        }
+        return mix;
+    }
+};
+
+#endif // MIXER_H
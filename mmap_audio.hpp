@@ -0,0 +1,126 @@
+#ifndef MMAP_AUDIO_H
+#define MMAP_AUDIO_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <span>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "audio.hpp"
+
+// Linux下的内存映射后端：整个文件映射为只读，读取时直接返回映射中的指针，
+// 音量等处理直接从页缓存读取，省去一次fread拷贝。播放位置前方按窗口提示内核预读
+class MmapAudio : public AudioBase {
+    static constexpr size_t readahead = 256 * 1024; // 播放位置前方提示预读的长度
+
+    const uint8_t* map{};
+    size_t map_size{};
+    size_t data_end{};      // 数据块结尾（不含其后的LIST等块）
+    size_t advised_end{};   // 已提示预读到的位置
+
+    // 提示内核预读[begin, begin + readahead)，起点需按页对齐
+    void advise_from(size_t begin) {
+        static const size_t page = sysconf(_SC_PAGESIZE);
+        begin &= ~(page - 1);
+        if (begin >= data_end)
+            return;
+        const size_t len = std::min(readahead, data_end - begin);
+        madvise(const_cast<uint8_t*>(map) + begin, len, MADV_WILLNEED);
+        advised_end = begin + len;
+    }
+    void advance(size_t n) {
+        samples_current_index += n;
+        // 预读窗口过半时提示下一个窗口
+        if (samples_current_index + readahead / 2 > advised_end)
+            advise_from(advised_end);
+    }
+    void unmap() {
+        if (map)
+            munmap(const_cast<uint8_t*>(map), map_size);
+        map = nullptr;
+        map_size = data_end = advised_end = 0;
+    }
+public:
+    MmapAudio() = default;
+    MmapAudio(std::string_view name) {
+        load(name);
+    }
+    MmapAudio(const MmapAudio&) = delete;
+    MmapAudio& operator=(const MmapAudio&) = delete;
+
+    int8_t load(std::string_view name) override {
+        unmap();
+        if (name.size() > PathString::capacity())
+            return -1; // 路径过长
+
+        const int fd = open(name.data(), O_RDONLY);
+        if (fd < 0)
+            return -1; // 打开文件失败
+        struct stat st;
+        // 32位系统上超过地址空间的文件无法整体映射
+        if (fstat(fd, &st) != 0 || st.st_size == 0 || uint64_t(st.st_size) > SIZE_MAX) {
+            ::close(fd);
+            return -1;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // 映射建立后不再需要文件描述符
+        if (p == MAP_FAILED)
+            return -1;
+        map = static_cast<const uint8_t*>(p);
+        map_size = st.st_size;
+        madvise(p, map_size, MADV_SEQUENTIAL);
+
+        auto read_at = [this](uint64_t offset, uint8_t* dst, size_t n) {
+            if (offset + n > map_size)
+                return false;
+            std::memcpy(dst, map + offset, n);
+            return true;
+        };
+        if (!parse_wav(read_at, map_size)) {
+            unmap();
+            return -1;
+        }
+        data_end = samples_start_index + data_size;
+        advise_from(samples_current_index);
+
+        this->name = name;
+
+        return 0;
+    }
+    bool is_valid() const override {
+        return map != nullptr;
+    }
+    void close() override {
+        unmap();
+    }
+    void seek_frame(uint64_t frame) override {
+        samples_current_index = std::min<uint64_t>(samples_start_index + frame * block_align(), data_end);
+        advise_from(samples_current_index); // 跳转后立即预读新位置
+    }
+    unsigned read(uint8_t buffer[], unsigned size) override {
+        auto v = view(size);
+        if (!v.empty())
+            std::memcpy(buffer, v.data(), v.size());
+        return v.size();
+    }
+    bool supports_view() const override {
+        return true;
+    }
+    std::span<const uint8_t> view(unsigned size) override {
+        if (!map)
+            return {};
+        const size_t n = std::min<uint64_t>(size, data_end - samples_current_index);
+        std::span<const uint8_t> v(map + samples_current_index, n);
+        advance(n);
+        return v;
+    }
+    ~MmapAudio() {
+        unmap();
+    }
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef PACK_AUDIO_H
+#define PACK_AUDIO_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <dirent.h>
+#include "audio.hpp"
+#include "pack_format.hpp"
+
+// 从打包曲库（.pak，见pack_format.hpp）中播放曲目
+// 歌曲名形如"/sdcard/music.pak/标题.wav"：前半部分为包文件，后半部分为包内的标题
+// 包文件与索引在第一次加载时打开并读入内存，之后在同一个包内切歌不再打开文件、查找目录或解析WAV头，
+// 只在内存索引中查找标题并定位一次
+// 偏移经过fseek，受long的范围限制（32位平台上为2GB），打包工具会把更大的曲库拆分为多个包
+class PackAudio : public AudioBase {
+    FILE* file{};
+    PathString pack_path;           // 当前打开的包文件
+    std::vector<PackEntry> entries; // 当前包的索引
+    const PackEntry* entry{};       // 当前曲目
+    char stdio_buf[512];            // 与Audio相同，stdio缓冲区放在对象内
+
+    // 读取包头与索引，out已预留max_count项，打开新包时不再申请内存
+    static bool read_index(FILE* f, std::vector<PackEntry>& out) {
+        PackHeader header;
+        if (fread(&header, sizeof header, 1, f) != 1 || !header.valid() || header.count > PackHeader::max_count)
+            return false;
+        out.resize(header.count);
+        return fread(out.data(), sizeof(PackEntry), out.size(), f) == out.size();
+    }
+    // 把歌曲名拆分为包文件与标题
+    static bool split(std::string_view name, std::string_view& pack, std::string_view& title) {
+        const size_t pos = name.rfind(".pak/");
+        if (pos == std::string_view::npos || pos + 5 >= name.size())
+            return false;
+        pack = name.substr(0, pos + 4);
+        title = name.substr(pos + 5);
+        return true;
+    }
+    bool open_pack(std::string_view pack) {
+        close_pack();
+        {
+            AllocGuard::Allow allow; // 文件系统为打开的文件申请内存，只在换包时发生
+            file = fopen(PathString(pack).c_str(), "rb");
+        }
+        if (!file)
+            return false;
+        setvbuf(file, stdio_buf, _IOFBF, sizeof stdio_buf);
+        if (!read_index(file, entries)) {
+            close_pack();
+            return false;
+        }
+        pack_path = pack;
+        return true;
+    }
+    void close_pack() {
+        if (file)
+            fclose(file);
+        file = nullptr;
+        entry = nullptr;
+        pack_path.clear();
+    }
+public:
+    static constexpr std::string_view extension = ".pak";
+
+    PackAudio() {
+        entries.reserve(PackHeader::max_count);
+    }
+    PackAudio(std::string_view name) : PackAudio() {
+        load(name);
+    }
+    PackAudio(const PackAudio&) = delete;
+    PackAudio& operator=(const PackAudio&) = delete;
+
+    int8_t load(std::string_view name) override {
+        entry = nullptr;
+        if (name.size() > PathString::capacity())
+            return -1; // 路径过长
+        std::string_view pack, title;
+        if (!split(name, pack, title))
+            return -1; // 不是包内的曲目
+        if (!file || pack_path.view() != pack) {
+            if (!open_pack(pack))
+                return -1; // 打开包文件失败
+        }
+
+        auto it = std::find_if(entries.begin(), entries.end(), [title](const PackEntry& e) {
+            return e.title_view() == title;
+        });
+        if (it == entries.end())
+            return -1; // 包内没有此曲目
+        if (it->offset + it->size > uint64_t(LONG_MAX))
+            return -1; // 超出fseek的范围
+        num_channels = it->num_channels;
+        sample_rate = it->sample_rate;
+        bit_depth = it->bit_depth;
+        byte_rate = bit_depth / 8 * sample_rate * num_channels;
+        samples_start_index = samples_current_index = it->offset;
+        data_size = it->size;
+        if (byte_rate == 0 || fseek(file, long(samples_start_index), SEEK_SET) != 0)
+            return -1;
+        entry = &*it;
+
+        this->name = name;
+
+        return 0;
+    }
+    bool is_valid() const override {
+        return file != nullptr && entry != nullptr;
+    }
+    // 当前曲目所在的包与在包内的序号，TrackInfo据此定位缓存（包文件本身不写入）
+    std::string_view archive() const {
+        return pack_path.view();
+    }
+    uint16_t entry_index() const {
+        return entry ? static_cast<uint16_t>(entry - entries.data()) : 0;
+    }
+    // 关闭包文件，下一次load()重新打开并读取索引
+    void close() override {
+        close_pack();
+    }
+    void seek_frame(uint64_t frame) override {
+        samples_current_index = samples_start_index + std::min(frame * block_align(), data_size);
+        fseek(file, long(samples_current_index), SEEK_SET);
+    }
+    // 不读到下一首的数据
+    unsigned read(uint8_t buffer[], unsigned size) override {
+        const uint64_t end = samples_start_index + data_size;
+        if (!is_valid() || samples_current_index >= end)
+            return 0;
+        const unsigned n = fread(buffer, sizeof *buffer, std::min<uint64_t>(size, end - samples_current_index), file);
+        samples_current_index += n;
+        return n;
+    }
+    ~PackAudio() {
+        close();
+    }
+
+    // 列出目录下所有包文件中的曲目，歌曲名可直接传给load()
+    static std::vector<std::string> scan_directory(std::string_view path) {
+        std::vector<std::string> song_list;
+
+        DIR* dir = opendir(path.data());
+        if (!dir) {
+            return song_list;
+        }
+
+        struct dirent* entry;
+        std::vector<PackEntry> index;
+        index.reserve(PackHeader::max_count);
+        while ((entry = readdir(dir)) != nullptr) {
+            if (entry->d_type == DT_DIR) {
+                continue;
+            }
+
+            std::string_view file_name = entry->d_name;
+            if (!file_name.ends_with(extension)) {
+                continue;
+            }
+            std::string pack_name = std::string(path);
+            if (!pack_name.empty() && pack_name.back() != '/') {
+                pack_name += '/';
+            }
+            pack_name += file_name;
+
+            FILE* f = fopen(pack_name.c_str(), "rb");
+            if (!f) {
+                continue;
+            }
+            if (read_index(f, index)) {
+                for (const auto& e : index)
+                    song_list.push_back(pack_name + '/' + std::string(e.title_view()));
+            }
+            fclose(f);
+        }
+
+        closedir(dir);
+        return song_list;
+    }
+};
+
+#endif // PACK_AUDIO_H
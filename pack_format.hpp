@@ -0,0 +1,51 @@
+#ifndef PACK_FORMAT_H
+#define PACK_FORMAT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// 打包曲库的文件格式，由tools/pack_music.cpp在主机上生成，PackAudio读取
+// 布局：[PackHeader][PackEntry × count][填充][曲目1的PCM][填充][曲目2的PCM]...
+// 每首的PCM数据起点按sector_size对齐，切歌时只需一次定位即可顺序读取
+// 所有字段为小端，主机与STM32均可直接按结构体读写
+struct PackEntry {
+    static constexpr size_t title_capacity = 96;
+
+    uint64_t offset;      // PCM数据在包内的偏移
+    uint64_t size;        // PCM数据长度（字节）
+    uint64_t frames;      // 帧数，即时长×采样率
+    uint32_t sample_rate;
+    uint8_t num_channels;
+    uint8_t bit_depth;
+    uint8_t title_len;
+    char title[title_capacity + 1]; // 原文件名，以'\0'结尾
+
+    std::string_view title_view() const {
+        return {title, std::min<size_t>(title_len, title_capacity)};
+    }
+};
+static_assert(sizeof(PackEntry) == 128);
+
+struct PackHeader {
+    static constexpr char magic_value[4] = {'W', 'P', 'A', 'K'};
+    static constexpr uint16_t current_version = 1;
+    static constexpr uint16_t max_count = 512; // 每个包的曲目上限，PackAudio按此一次预留索引
+
+    char magic[4];
+    uint16_t version;
+    uint16_t count;       // 曲目数
+    uint16_t entry_size;  // sizeof(PackEntry)，读取时用于检查兼容性
+    uint16_t sector_size; // PCM数据的对齐长度
+    uint32_t reserved;
+
+    bool valid() const {
+        return std::memcmp(magic, magic_value, sizeof magic) == 0 && version == current_version
+            && entry_size == sizeof(PackEntry);
+    }
+};
+static_assert(sizeof(PackHeader) == 16);
+
+#endif // PACK_FORMAT_H
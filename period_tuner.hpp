@@ -0,0 +1,55 @@
+#ifndef PERIOD_TUNER_H
+#define PERIOD_TUNER_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// 根据读取耗时的分位数选择DMA半区长度（采样点数）
+// 每window次读取统计一次p99：超过半区播放时长的1/2时加倍，低于1/8且最大值低于1/4时减半，
+// 两个阈值相隔4倍，调整后不会在相邻长度间来回切换
+class PeriodTuner {
+public:
+    static constexpr uint32_t window = 128;
+private:
+    std::array<uint16_t, 24> hist{}; // 对数直方图，第b格为[2^(b-1), 2^b)微秒
+    uint32_t count{};
+    uint32_t peak{};
+    uint32_t p99{}, max{};
+public:
+    // 记录一次读取耗时，窗口结束时返回建议的半区长度，否则返回period
+    // period_us为当前半区的播放时长，结果限制在[min_period, max_period]
+    size_t record(uint32_t us, size_t period, uint32_t period_us, size_t min_period, size_t max_period) {
+        ++hist[std::min<size_t>(std::bit_width(us), hist.size() - 1)];
+        peak = std::max(peak, us);
+        if (++count < window)
+            return period;
+
+        // 取所在格的上界，偏保守
+        uint32_t seen = 0, b = 0;
+        const uint32_t rank = window - window / 100;
+        while (b < hist.size() && (seen += hist[b]) < rank)
+            ++b;
+        p99 = b ? (1u << b) - 1 : 0;
+        max = peak;
+        hist.fill(0);
+        count = peak = 0;
+
+        if (p99 * 2 > period_us && period * 2 <= max_period)
+            return period * 2;
+        if (p99 * 8 < period_us && max * 4 < period_us && period / 2 >= min_period) // 减半后最慢的一次仍不超过半区时长的一半
+            return period / 2;
+        return period;
+    }
+    // 上一个窗口的p99与最大值
+    uint32_t p99_us() const {
+        return p99;
+    }
+    uint32_t max_us() const {
+        return max;
+    }
+};
+
+#endif // PERIOD_TUNER_H
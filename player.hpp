@@ -1,26 +1,92 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <concepts>
+#include <chrono>
+#include <cmath>
 #include <random>
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <cstdio>
 #include <functional>
 #include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 #include <lvgl.h>
 #include "lock.hpp"
+#include "alloc_guard.hpp"
+#include "spsc_queue.hpp"
 #include "audio.hpp"
 #include "audio_device.hpp"
+#include "mixer.hpp"
+#include "equalizer.hpp"
+#include "track_info.hpp"
+#include "spectrum.hpp"
+#include "level_meter.hpp"
+#include "period_tuner.hpp"
+#include "resume_state.hpp"
+#include "triple_buffer.hpp"
 
 LV_FONT_DECLARE(zh)
 
-class Player {
+template<AudioDeviceType Device = AudioDevice, LockPolicy Lock = FunctionLock, AudioSourceType Source = Audio>
+class BasicPlayer {
 public:
     using Playlist = std::vector<std::string>;
+
+    // 运行统计
+    struct Stats {
+        uint32_t underruns; // 循环模式下DMA重放旧数据的次数
+        uint32_t commands_dropped; // 命令队列满时丢弃的命令数
+        uint32_t command_latency_us; // 最近一条命令从投递到执行的耗时，听到效果还需再加一个缓冲区时长
+        uint32_t command_latency_max_us;
+        uint32_t process_us; // 最近一个缓冲区的均衡、混音、音量与电平处理耗时
+        uint32_t process_max_us;
+        uint32_t resume_us; // 最近一次从play()到声音恢复的耗时，不含命令排队时间（见command_latency_us）
+        uint32_t resume_max_us;
+        uint16_t period;         // 当前每个半区的采样点数
+        uint32_t period_changes; // 半区长度的调整次数
+        uint32_t read_p99_us;    // 最近一个统计窗口的读取耗时p99（对数分格的上界）与最大值
+        uint32_t read_max_us;
+        uint32_t open_us;        // 最近一次切歌时打开歌曲（song.load()）的耗时，用于比较散装文件与打包曲库
+        uint32_t open_max_us;
+        uint32_t first_sample_us; // 从init()到第一个采样送入DMA的耗时，0表示尚未播放
+        uint32_t state_saves;     // 续播状态实际写入存储卡的次数（由write_state()完成）
+    };
+
+    // poll()返回后调用者需要等待的事件
+    enum class Wait : uint8_t {
+        NONE,       // 还有工作，立即再次调用
+        COMMAND,    // 未在播放，等待play()或投递命令（post()会唤醒cv）
+        DMA         // 等待DMA事件（循环模式的半区中断或非循环模式的传输完成）
+    };
+
+    // UI线程投递给播放线程的命令
+    struct Command {
+        enum class Type : uint8_t {
+            TOGGLE,     // 播放/暂停
+            PLAY,
+            PAUSE,
+            PREV,
+            NEXT,
+            LOAD,       // arg: 歌曲索引
+            SEEK,       // arg: 秒
+            VOLUME,     // arg: 0-100
+            MODE,       // 切换播放模式
+            SLEEP       // arg: 睡眠定时分钟数，0为关闭
+        } type;
+        uint32_t arg;
+        std::chrono::steady_clock::time_point posted;
+    };
     
     // 播放模式枚举
     enum class PlayMode {
@@ -30,12 +96,14 @@ public:
     };
 
 private:
-    std::function<void(Playlist&)> list_shuffle = [](Playlist& pl) {
-        std::ranges::shuffle(pl, std::default_random_engine(0));
+    // 随机模式下打乱播放顺序，参数为歌曲在扫描顺序中的下标与种子
+    // 相同的种子须得到相同的顺序，断电续播时据此恢复随机播放的顺序
+    std::function<void(std::span<uint16_t>, uint32_t)> list_shuffle = [](std::span<uint16_t> order, uint32_t seed) {
+        std::ranges::shuffle(order, std::default_random_engine(seed));
     };
 
     struct UI {
-        Player* player;
+        BasicPlayer* player;
         lv_obj_t* songName_label;
         lv_obj_t* curTime_label;
         lv_obj_t* totalTime_label;
@@ -49,20 +117,42 @@ private:
         lv_obj_t* vol_btn;
         lv_obj_t* playlist_list;
         lv_obj_t* playlist_btn;
+        lv_obj_t* sleep_btn;
+        lv_obj_t* sleep_list;      // 睡眠定时选项弹窗
+        lv_obj_t* middle_area;
+        lv_obj_t* level_area;
+        lv_obj_t* progress_row;
+        const lv_font_t* font = &zh; // 歌曲名和歌单使用的字体
+        // 共享样式：多个控件引用同一份，不为每个控件单独分配本地样式
+        struct {
+            lv_style_t plain;    // 透明、无边框、无内边距的容器
+            lv_style_t round;    // 圆形按钮
+            lv_style_t popup;    // 弹窗
+            lv_style_t title;    // 歌曲名和歌单字体
+            lv_style_t selected; // 歌单当前行
+        } styles;
         bool is_dragging_progress = false;
-        UI(Player* p) : player(p) {}
+        // 控件当前显示的内容，只在变化时才修改控件，避免无谓的重绘
+        int32_t shown_bar = -1, shown_time = -1, shown_total = -1, shown_volume = -1;
+        int8_t shown_playing = -1, shown_mode = -1;
+        int32_t shown_sleep = 0;   // 睡眠定时剩余分钟数，0为未定时
+        static constexpr uint16_t sleep_options[] = {0, 15, 30, 60, 90}; // 分钟，0为关闭
+        uint8_t marquee_cycles = 0; // 歌曲名滚动几圈后停止，0表示一直滚动
+        bool has_overview = false;
+        std::array<int8_t, TrackInfo::overview_bins> overview_min{}, overview_max{};
+        UI(BasicPlayer* p) : player(p) {}
         void event_init() {
             // 播放/暂停
             lv_obj_add_event_cb(play_btn, [](lv_event_t* e) {
-                static_cast<Player*>(lv_event_get_user_data(e))->toggle_play_pause();
+                static_cast<BasicPlayer*>(lv_event_get_user_data(e))->post(Command::Type::TOGGLE);
             }, LV_EVENT_CLICKED, this->player);
             // 上一曲
             lv_obj_add_event_cb(prev_btn, [](lv_event_t* e) {
-                static_cast<Player*>(lv_event_get_user_data(e))->prev_song();
+                static_cast<BasicPlayer*>(lv_event_get_user_data(e))->post(Command::Type::PREV);
             }, LV_EVENT_CLICKED, this->player);
             // 下一曲
             lv_obj_add_event_cb(next_btn, [](lv_event_t* e) {
-                static_cast<Player*>(lv_event_get_user_data(e))->next_song();
+                static_cast<BasicPlayer*>(lv_event_get_user_data(e))->post(Command::Type::NEXT);
             }, LV_EVENT_CLICKED, this->player);
             // 进度条
             lv_obj_add_event_cb(progress_bar, [](lv_event_t* e) {
@@ -76,19 +166,20 @@ private:
                     ui->is_dragging_progress = true;
                     lv_obj_set_width(progress_bar, LV_PCT(95));
                     lv_obj_remove_flag(ui->dragTime_label, LV_OBJ_FLAG_HIDDEN);
-                    lv_label_set_text_fmt(ui->dragTime_label, "%02d:%02d", value / 60, value % 60);
+                    time_set(ui->dragTime_label, value);
                 } else if (event_code == LV_EVENT_VALUE_CHANGED) {
                     // 拖动过程中只更新UI显示，不改变播放位置
-                    lv_label_set_text_fmt(ui->dragTime_label, "%02d:%02d", value / 60, value % 60);
+                    time_set(ui->dragTime_label, value);
                 } else if (event_code == LV_EVENT_RELEASED) {
                     // 松开时恢复原始宽度并应用新的播放位置
                     ui->is_dragging_progress = false;
                     lv_obj_set_width(progress_bar, LV_PCT(90));  // 恢复到90%
                     lv_obj_add_flag(ui->dragTime_label, LV_OBJ_FLAG_HIDDEN);
+                    ui->shown_bar = value; // 进度条已被拖到此处
                     ui->progress_update(value, false, true); // 更新当前时间显示
                     
                     // 跳转音频位置
-                    ui->player->seek(value);
+                    ui->player->post(Command::Type::SEEK, value);
                 }
             }, LV_EVENT_ALL, this);
             // 音量
@@ -98,7 +189,7 @@ private:
                 auto vol_value = lv_slider_get_value(static_cast<lv_obj_t*>(lv_event_get_target(e)));
                 
                 if (event_code == LV_EVENT_RELEASED) {
-                    ui->player->device->set_volume(vol_value);
+                    ui->player->post(Command::Type::VOLUME, vol_value);
                 }
             }, LV_EVENT_ALL, this);
             // 歌单按钮事件：弹出/隐藏歌单
@@ -124,35 +215,80 @@ private:
             // 播放模式按钮事件
             lv_obj_add_event_cb(mode_btn, [](lv_event_t* e) {
                 auto ui = static_cast<UI*>(lv_event_get_user_data(e));
-                ui->player->switch_play_mode();
+                ui->player->post(Command::Type::MODE);
+            }, LV_EVENT_CLICKED, this);
+            // 睡眠定时按钮事件：弹出/隐藏选项
+            lv_obj_add_event_cb(sleep_btn, [](lv_event_t* e) {
+                auto ui = static_cast<UI*>(lv_event_get_user_data(e));
+                if (lv_obj_has_flag(ui->sleep_list, LV_OBJ_FLAG_HIDDEN)) {
+                    lv_obj_remove_flag(ui->sleep_list, LV_OBJ_FLAG_HIDDEN);
+                    lv_obj_move_foreground(ui->sleep_list);
+                } else {
+                    lv_obj_add_flag(ui->sleep_list, LV_OBJ_FLAG_HIDDEN);
+                }
             }, LV_EVENT_CLICKED, this);
         }
-        void init() {
-            // 创建主容器，填充整个屏幕
-            auto main_cont = lv_obj_create(lv_screen_active());
+        void styles_init() {
+            lv_style_init(&styles.plain);
+            lv_style_set_border_width(&styles.plain, 0);
+            lv_style_set_bg_opa(&styles.plain, LV_OPA_0);
+            lv_style_set_pad_all(&styles.plain, 0);
+
+            lv_style_init(&styles.round);
+            lv_style_set_radius(&styles.round, LV_RADIUS_CIRCLE);
+
+            lv_style_init(&styles.popup);
+            lv_style_set_bg_color(&styles.popup, lv_color_hex(0xffffff));
+            lv_style_set_bg_opa(&styles.popup, LV_OPA_COVER);
+            lv_style_set_border_width(&styles.popup, 2);
+            lv_style_set_radius(&styles.popup, 10);
+            lv_style_set_pad_all(&styles.popup, 0);
+
+            lv_style_init(&styles.title);
+            lv_style_set_text_font(&styles.title, font);
+
+            lv_style_init(&styles.selected);
+            lv_style_set_bg_color(&styles.selected, lv_color_hex(0x007BFF));
+        }
+        lv_obj_t* plain_create(lv_obj_t* parent) {
+            auto obj = lv_obj_create(parent);
+            lv_obj_add_style(obj, &styles.plain, 0);
+            return obj;
+        }
+        lv_obj_t* round_btn_create(lv_obj_t* parent, int32_t size, const char* symbol) {
+            auto btn = lv_btn_create(parent);
+            lv_obj_set_size(btn, size, size);
+            lv_obj_add_style(btn, &styles.round, 0);
+            auto label = lv_label_create(btn);
+            lv_label_set_text(label, symbol);
+            lv_obj_center(label);
+            return btn;
+        }
+        void init(lv_obj_t* parent) {
+            styles_init();
+
+            // 主容器填充整个屏幕，其余控件尽量直接挂在主容器上按坐标对齐，减少嵌套的透明容器
+            auto main_cont = lv_obj_create(parent);
             lv_obj_set_size(main_cont, LV_HOR_RES, LV_VER_RES);
             lv_obj_set_style_pad_all(main_cont, 0, 0);
             lv_obj_remove_flag(main_cont, LV_OBJ_FLAG_SCROLLABLE);
 
-            // 顶部区域 - 歌曲名称
-            auto top_area = lv_obj_create(main_cont);
-            lv_obj_set_size(top_area, LV_PCT(100), LV_VER_RES / 10);
-            lv_obj_set_style_border_width(top_area, 0, 0);
-            lv_obj_set_style_bg_opa(top_area, LV_OPA_0, 0);
-            lv_obj_set_style_pad_ver(top_area, 10, 0);
-            lv_obj_align(top_area, LV_ALIGN_TOP_MID, 0, 0);
-
-            // 歌曲名标签
-            songName_label = lv_label_create(top_area);
+            // 顶部 - 歌曲名标签
+            songName_label = lv_label_create(main_cont);
             lv_label_set_text(songName_label, "无播放歌曲");
-            lv_obj_set_style_text_font(songName_label, &zh, 0);
+            lv_obj_add_style(songName_label, &styles.title, 0);
             lv_obj_set_width(songName_label, LV_PCT(90));
             lv_obj_set_style_text_align(songName_label, LV_TEXT_ALIGN_CENTER, 0);
             lv_label_set_long_mode(songName_label, LV_LABEL_LONG_SCROLL_CIRCULAR);
-            lv_obj_align(songName_label, LV_ALIGN_CENTER, 0, 0);
+            lv_obj_align(songName_label, LV_ALIGN_TOP_MID, 0, LV_VER_RES / 30);
+            // 滚动停止后点击歌曲名重新滚动
+            lv_obj_add_flag(songName_label, LV_OBJ_FLAG_CLICKABLE);
+            lv_obj_add_event_cb(songName_label, [](lv_event_t* e) {
+                static_cast<UI*>(lv_event_get_user_data(e))->marquee_start();
+            }, LV_EVENT_CLICKED, this);
 
-            // 中间占位区域 - 为未来扩展准备
-            auto middle_area = lv_obj_create(main_cont);
+            // 中间区域 - 频谱
+            middle_area = lv_obj_create(main_cont);
             // 将高宽比调整为接近1:1的方形，使用固定尺寸
             const uint16_t square_size = LV_HOR_RES * 0.65; // 宽度的65%
             lv_obj_set_size(middle_area, square_size, square_size);
@@ -162,31 +298,16 @@ private:
             lv_obj_set_style_bg_opa(middle_area, LV_OPA_20, 0);
             lv_obj_align(middle_area, LV_ALIGN_CENTER, 0, -LV_VER_RES / 5);
 
-            // 底部区域
-            auto bottom_area = lv_obj_create(main_cont);
-            lv_obj_set_size(bottom_area, LV_PCT(90), LV_VER_RES / 3);
-            lv_obj_set_style_border_width(bottom_area, 0, 0);
-            lv_obj_set_style_bg_opa(bottom_area, LV_OPA_0, 0);
-            lv_obj_set_style_pad_all(bottom_area, 0, 0);
-            lv_obj_align(bottom_area, LV_ALIGN_BOTTOM_MID, 0, 0);
-            lv_obj_set_flex_flow(bottom_area, LV_FLEX_FLOW_COLUMN);
-            lv_obj_set_flex_align(bottom_area, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-            
-            // 进度区域
-            auto progress_area = lv_obj_create(bottom_area);
-            lv_obj_set_size(progress_area, LV_PCT(100), LV_SIZE_CONTENT);
-            lv_obj_set_style_border_width(progress_area, 0, 0);
-            lv_obj_set_style_bg_opa(progress_area, LV_OPA_0, 0);
-            lv_obj_set_style_pad_all(progress_area, 0, 0);
-            lv_obj_set_flex_flow(progress_area, LV_FLEX_FLOW_COLUMN);
-            lv_obj_set_flex_align(progress_area, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-            
+            // 电平表 - 位于中间区域右侧
+            level_area = plain_create(main_cont);
+            lv_obj_set_size(level_area, 12, square_size);
+            lv_obj_align_to(level_area, middle_area, LV_ALIGN_OUT_RIGHT_MID, 6, 0);
+
+            // 底部三分之一：进度条行、时间标签、两行控制按钮
             // 进度条行（独立占一行）
-            auto progress_row = lv_obj_create(progress_area);
-            lv_obj_set_size(progress_row, LV_PCT(100), 20);
-            lv_obj_set_style_border_width(progress_row, 0, 0);
-            lv_obj_set_style_bg_opa(progress_row, LV_OPA_0, 0);
-            lv_obj_set_style_pad_all(progress_row, 0, 0);
+            progress_row = plain_create(main_cont);
+            lv_obj_set_size(progress_row, LV_PCT(90), 20);
+            lv_obj_align(progress_row, LV_ALIGN_TOP_MID, 0, LV_VER_RES - LV_VER_RES / 3);
             
             // 进度条
             progress_bar = lv_slider_create(progress_row);
@@ -200,22 +321,18 @@ private:
             lv_obj_set_style_radius(progress_bar, 0, LV_PART_KNOB);
             lv_obj_set_style_bg_opa(progress_bar, LV_OPA_0, LV_PART_KNOB);
             lv_obj_set_style_border_width(progress_bar, 0, LV_PART_KNOB);
-            
-            // 时间标签行
-            auto time_row = lv_obj_create(progress_area);
-            lv_obj_set_size(time_row, LV_PCT(100), LV_SIZE_CONTENT);
-            lv_obj_set_style_border_width(time_row, 0, 0);
-            lv_obj_set_style_bg_opa(time_row, LV_OPA_0, 0);
-            lv_obj_set_style_pad_ver(time_row, 0, 0);
-            lv_obj_remove_flag(time_row, LV_OBJ_FLAG_SCROLLABLE);
-
-            // 当前时间标签 - 左对齐
-            curTime_label = lv_label_create(time_row);
+            // 波形概览绘制在进度条所在行的背景上，位于进度条之后
+            lv_obj_add_event_cb(progress_row, [](lv_event_t* e) {
+                static_cast<UI*>(lv_event_get_user_data(e))->overview_draw(lv_event_get_layer(e));
+            }, LV_EVENT_DRAW_MAIN, this);
+
+            // 当前时间标签 - 进度条行下方左侧
+            curTime_label = lv_label_create(main_cont);
             lv_label_set_text(curTime_label, "00:00");
-            lv_obj_align(curTime_label, LV_ALIGN_LEFT_MID, 10, 0);
+            lv_obj_align_to(curTime_label, progress_row, LV_ALIGN_OUT_BOTTOM_LEFT, 10, 0);
 
             // 拖动时间标签（紧贴curTime_label右边显示）
-            dragTime_label = lv_label_create(time_row);
+            dragTime_label = lv_label_create(main_cont);
             lv_label_set_text(dragTime_label, "00:00");
             lv_obj_set_style_bg_color(dragTime_label, lv_color_hex(0xF0F0F0), 0);   // 灰色背景
             lv_obj_set_style_bg_opa(dragTime_label, LV_OPA_COVER, 0);               // 完全不透明背景
@@ -223,107 +340,90 @@ private:
             lv_obj_align_to(dragTime_label, curTime_label, LV_ALIGN_OUT_RIGHT_MID, 5, 0);  // 紧贴curTime_label右边
             lv_obj_add_flag(dragTime_label, LV_OBJ_FLAG_HIDDEN);  // 初始隐藏
             
-            // 总时间标签 - 右对齐，位置固定
-            totalTime_label = lv_label_create(time_row);
+            // 总时间标签 - 进度条行下方右侧，位置固定
+            totalTime_label = lv_label_create(main_cont);
             lv_label_set_text(totalTime_label, "00:00");
-            lv_obj_align(totalTime_label, LV_ALIGN_RIGHT_MID, -10, 0);
-
-            // 控制按钮区域
-            auto control_area = lv_obj_create(bottom_area);
-            lv_obj_set_size(control_area, LV_PCT(100), LV_VER_RES / 4);
-            lv_obj_set_style_border_width(control_area, 0, 0);
-            lv_obj_set_style_bg_opa(control_area, LV_OPA_0, 0);
-            lv_obj_set_style_pad_all(control_area, 0, 0);
-            lv_obj_set_flex_flow(control_area, LV_FLEX_FLOW_COLUMN);
-            lv_obj_set_flex_align(control_area, LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-            lv_obj_remove_flag(control_area, LV_OBJ_FLAG_SCROLLABLE);
-            
+            lv_obj_align_to(totalTime_label, progress_row, LV_ALIGN_OUT_BOTTOM_RIGHT, -10, 0);
+
             // 主控制按钮行 - 播放控制
-            auto main_control_row = lv_obj_create(control_area);
-            lv_obj_set_size(main_control_row, LV_PCT(100), LV_SIZE_CONTENT);
-            lv_obj_set_style_border_width(main_control_row, 0, 0);
-            lv_obj_set_style_bg_opa(main_control_row, LV_OPA_0, 0);
+            auto main_control_row = plain_create(main_cont);
+            lv_obj_set_size(main_control_row, LV_PCT(90), LV_SIZE_CONTENT);
             lv_obj_set_style_pad_ver(main_control_row, 10, 0);
             lv_obj_set_flex_flow(main_control_row, LV_FLEX_FLOW_ROW);
             lv_obj_set_flex_align(main_control_row, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+            lv_obj_remove_flag(main_control_row, LV_OBJ_FLAG_SCROLLABLE);
+            lv_obj_align(main_control_row, LV_ALIGN_BOTTOM_MID, 0, -52);
+
+            prev_btn = round_btn_create(main_control_row, 45, LV_SYMBOL_PREV); // 上一曲
+            play_btn = round_btn_create(main_control_row, 50, LV_SYMBOL_PLAY); // 播放/暂停，稍大
+            next_btn = round_btn_create(main_control_row, 45, LV_SYMBOL_NEXT); // 下一曲
 
-            // 上一曲按钮
-            prev_btn = lv_btn_create(main_control_row);
-            lv_obj_set_size(prev_btn, 45, 45);
-            lv_obj_set_style_radius(prev_btn, LV_RADIUS_CIRCLE, 0);
-            auto prev_label = lv_label_create(prev_btn);
-            lv_label_set_text(prev_label, LV_SYMBOL_PREV);
-            lv_obj_center(prev_label);
-
-            // 播放/暂停按钮
-            play_btn = lv_btn_create(main_control_row);
-            lv_obj_set_size(play_btn, 50, 50);  // 播放按钮稍大
-            lv_obj_set_style_radius(play_btn, LV_RADIUS_CIRCLE, 0);
-            auto play_label = lv_label_create(play_btn);
-            lv_label_set_text(play_label, LV_SYMBOL_PLAY);
-            lv_obj_center(play_label);
-
-            // 下一曲按钮
-            next_btn = lv_btn_create(main_control_row);
-            lv_obj_set_size(next_btn, 45, 45);
-            lv_obj_set_style_radius(next_btn, LV_RADIUS_CIRCLE, 0);
-            auto next_label = lv_label_create(next_btn);
-            lv_label_set_text(next_label, LV_SYMBOL_NEXT);
-            lv_obj_center(next_label);
-
-            // 辅助控制行 - 音量和播放列表按钮
-            auto aux_control_row = lv_obj_create(control_area);
-            lv_obj_set_size(aux_control_row, LV_PCT(80), LV_SIZE_CONTENT);
-            lv_obj_set_style_border_width(aux_control_row, 0, 0);
-            lv_obj_set_style_bg_opa(aux_control_row, LV_OPA_0, 0);
+            // 辅助控制行 - 播放模式、音量和播放列表按钮
+            auto aux_control_row = plain_create(main_cont);
+            lv_obj_set_size(aux_control_row, LV_PCT(72), LV_SIZE_CONTENT);
             lv_obj_set_style_pad_bottom(aux_control_row, 8, 0);
             lv_obj_set_flex_flow(aux_control_row, LV_FLEX_FLOW_ROW);
             lv_obj_set_flex_align(aux_control_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+            lv_obj_remove_flag(aux_control_row, LV_OBJ_FLAG_SCROLLABLE);
             lv_obj_align(aux_control_row, LV_ALIGN_BOTTOM_MID, 0, 0);
 
-            // 音量按钮 - 较小
-            vol_btn = lv_btn_create(aux_control_row);
-            lv_obj_set_size(vol_btn, 36, 36); // 减小大小
-            lv_obj_set_style_radius(vol_btn, LV_RADIUS_CIRCLE, 0);
-            auto vol_label = lv_label_create(vol_btn);
-            lv_label_set_text(vol_label, LV_SYMBOL_VOLUME_MAX);
-            lv_obj_center(vol_label);
-
-            // 播放模式按钮 - 在音量按钮左侧
-            mode_btn = lv_btn_create(aux_control_row);
-            lv_obj_set_size(mode_btn, 36, 36);
-            lv_obj_set_style_radius(mode_btn, LV_RADIUS_CIRCLE, 0);
-            auto mode_label = lv_label_create(mode_btn);
-            lv_label_set_text(mode_label, LV_SYMBOL_LOOP); // 默认循环模式图标
-            lv_obj_center(mode_label);
-            // 将模式按钮移动到音量按钮前面
-            lv_obj_move_to_index(mode_btn, lv_obj_get_index(vol_btn));
-
-            // 歌单按钮 - 较小
-            playlist_btn = lv_btn_create(aux_control_row);
-            lv_obj_set_size(playlist_btn, 36, 36); // 减小大小
-            lv_obj_set_style_radius(playlist_btn, LV_RADIUS_CIRCLE, 0);
-            auto list_label = lv_label_create(playlist_btn);
-            lv_label_set_text(list_label, LV_SYMBOL_LIST);
-            lv_obj_center(list_label);
-
-            // 歌曲列表弹窗（初始隐藏），用lv_list替换
-            playlist_list = lv_list_create(lv_screen_active());
+            mode_btn = round_btn_create(aux_control_row, 36, LV_SYMBOL_LOOP); // 默认循环模式图标
+            vol_btn = round_btn_create(aux_control_row, 36, LV_SYMBOL_VOLUME_MAX);
+            sleep_btn = round_btn_create(aux_control_row, 36, LV_SYMBOL_POWER); // 定时后显示剩余分钟数
+            playlist_btn = round_btn_create(aux_control_row, 36, LV_SYMBOL_LIST);
+
+            // 歌曲列表弹窗（初始隐藏），字体由各行标签继承
+            playlist_list = lv_list_create(parent);
             lv_obj_set_size(playlist_list, LV_PCT(70), LV_PCT(70));
-            lv_obj_set_style_bg_color(playlist_list, lv_color_hex(0xffffff), 0);
-            lv_obj_set_style_border_width(playlist_list, 2, 0);
-            lv_obj_set_style_radius(playlist_list, 10, 0);
-            lv_obj_set_style_pad_all(playlist_list, 0, 0);
-            lv_obj_set_style_bg_opa(playlist_list, LV_OPA_COVER, 0);
+            lv_obj_add_style(playlist_list, &styles.popup, 0);
+            lv_obj_add_style(playlist_list, &styles.title, 0);
             lv_obj_center(playlist_list);
             lv_obj_add_flag(playlist_list, LV_OBJ_FLAG_HIDDEN);
+            // 各行的点击事件冒泡到列表，只注册一个回调
+            lv_obj_add_event_cb(playlist_list, [](lv_event_t* e) {
+                auto ui = static_cast<UI*>(lv_event_get_user_data(e));
+                auto btn = static_cast<lv_obj_t*>(lv_event_get_target(e));
+                if (btn == ui->playlist_list || lv_obj_get_parent(btn) != ui->playlist_list)
+                    return;
+                auto index = lv_obj_get_index(btn);
+                ui->playlist_update(index);
+                ui->player->post(Command::Type::LOAD, index);
+            }, LV_EVENT_CLICKED, this);
+
+            // 睡眠定时弹窗（初始隐藏），第一行为标题，其后依次为sleep_options
+            sleep_list = lv_list_create(parent);
+            lv_obj_set_size(sleep_list, LV_PCT(50), LV_SIZE_CONTENT);
+            lv_obj_add_style(sleep_list, &styles.popup, 0);
+            lv_obj_add_style(sleep_list, &styles.title, 0);
+            lv_obj_center(sleep_list);
+            lv_obj_add_flag(sleep_list, LV_OBJ_FLAG_HIDDEN);
+            lv_list_add_text(sleep_list, "睡眠定时");
+            for (auto minutes : sleep_options) {
+                char text[16];
+                if (minutes)
+                    snprintf(text, sizeof text, "%u 分钟", minutes);
+                else
+                    snprintf(text, sizeof text, "关闭");
+                auto btn = lv_list_add_button(sleep_list, nullptr, text);
+                lv_obj_add_flag(btn, LV_OBJ_FLAG_EVENT_BUBBLE);
+            }
+            lv_obj_add_event_cb(sleep_list, [](lv_event_t* e) {
+                auto ui = static_cast<UI*>(lv_event_get_user_data(e));
+                auto btn = static_cast<lv_obj_t*>(lv_event_get_target(e));
+                if (btn == ui->sleep_list || lv_obj_get_parent(btn) != ui->sleep_list)
+                    return;
+                const auto index = lv_obj_get_index(btn);
+                if (index < 1 || index > int32_t(std::size(sleep_options)))
+                    return; // 标题行
+                lv_obj_add_flag(ui->sleep_list, LV_OBJ_FLAG_HIDDEN);
+                ui->player->post(Command::Type::SLEEP, sleep_options[index - 1]);
+            }, LV_EVENT_CLICKED, this);
 
             // 音量弹窗（初始隐藏）
-            vol_slider = lv_slider_create(lv_screen_active());
+            vol_slider = lv_slider_create(parent);
             lv_obj_set_size(vol_slider, LV_PCT(50), 40);
+            lv_obj_add_style(vol_slider, &styles.popup, 0);
             lv_obj_set_style_bg_color(vol_slider, lv_color_hex(0xf0f0f0), 0);
-            lv_obj_set_style_border_width(vol_slider, 2, 0);
-            lv_obj_set_style_radius(vol_slider, 10, 0);
             lv_obj_set_style_pad_all(vol_slider, 8, 0);
             lv_slider_set_range(vol_slider, 0, 100);
             lv_obj_center(vol_slider);
@@ -336,78 +436,129 @@ private:
             for (size_t i = 0; i < lv_obj_get_child_count(playlist_list); ++i) {
                 auto child = lv_obj_get_child(playlist_list, i);
                 if (i == index)
-                    lv_obj_set_style_bg_color(child, lv_color_hex(0x007BFF), LV_PART_MAIN);
+                    lv_obj_add_state(child, LV_STATE_CHECKED);
                 else
-                    lv_obj_set_style_bg_color(child, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
+                    lv_obj_remove_state(child, LV_STATE_CHECKED);
             }
         }
-        void playlist_load(const Playlist& new_playlist) {
+        // 按播放顺序显示
+        void playlist_load() {
             if (player->playlist.empty())
                 return;
 
             // 清空列表
             playlist_clear();
 
-            auto event_handler = [](lv_event_t* e) {
-                auto ui = static_cast<UI*>(lv_event_get_user_data(e));
-                auto btn = static_cast<lv_obj_t*>(lv_event_get_target(e));
-                
-                if(lv_event_get_code(e) == LV_EVENT_CLICKED) {
-                    auto parent = lv_obj_get_parent(btn);
-                    for(uint32_t i = 0; i < lv_obj_get_child_count(parent); ++i) {
-                        auto child = lv_obj_get_child(parent, i);
-                        if(child == btn) {
-                            lv_obj_set_style_bg_color(child, lv_color_hex(0x007BFF), LV_PART_MAIN);
-                            ui->player->load(i);
-                        }
-                        else
-                            lv_obj_set_style_bg_color(child, lv_color_hex(0xFFFFFF), LV_PART_MAIN);
-                    }
-                }
-            };
-
-            // 重新添加所有歌曲
-            for (size_t i = 0; i < new_playlist.size(); ++i) {
-                auto btn = lv_list_add_button(playlist_list, nullptr, new_playlist[i].c_str());
-                auto label = lv_obj_get_child(btn, 0);
-                lv_obj_set_style_text_font(label, &zh, 0);
+            // 重新添加所有歌曲，行只引用共享样式
+            for (size_t i = 0; i < player->order.size(); ++i) {
+                auto btn = lv_list_add_button(playlist_list, nullptr, player->playlist[player->order[i]].c_str());
+                lv_obj_add_style(btn, &styles.selected, LV_PART_MAIN | LV_STATE_CHECKED);
+                lv_obj_add_flag(btn, LV_OBJ_FLAG_EVENT_BUBBLE);
                 if (i == player->current_song_index)
-                    lv_obj_set_style_bg_color(btn, lv_color_hex(0x007BFF), LV_PART_MAIN);
-                // 事件：点击切换歌曲
-                lv_obj_add_event_cb(btn, event_handler, LV_EVENT_ALL, this);
+                    lv_obj_add_state(btn, LV_STATE_CHECKED);
             }
         }
-        void progress_set_range(uint16_t total_time) {
+        template<typename T>
+        static bool changed(T& shown, T value) {
+            if (shown == value)
+                return false;
+            shown = value;
+            return true;
+        }
+        // 一小时以上显示为h:mm:ss
+        static void time_set(lv_obj_t* label, uint32_t time) {
+            if (time >= 3600)
+                lv_label_set_text_fmt(label, "%lu:%02lu:%02lu", static_cast<unsigned long>(time / 3600),
+                    static_cast<unsigned long>(time / 60 % 60), static_cast<unsigned long>(time % 60));
+            else
+                lv_label_set_text_fmt(label, "%02lu:%02lu", static_cast<unsigned long>(time / 60),
+                    static_cast<unsigned long>(time % 60));
+        }
+        void progress_set_range(uint32_t total_time) {
+            if (!changed<int32_t>(shown_total, total_time))
+                return;
             lv_slider_set_range(progress_bar, 0, total_time);
-            lv_label_set_text_fmt(totalTime_label, "%02d:%02d", total_time / 60, total_time % 60);
+            time_set(totalTime_label, total_time);
         }
-        void progress_update(uint16_t time, bool update_bar = true, bool update_time = true) {
-            if (update_bar)
+        void progress_update(uint32_t time, bool update_bar = true, bool update_time = true) {
+            if (update_bar && changed<int32_t>(shown_bar, time))
                 lv_slider_set_value(progress_bar, time, LV_ANIM_OFF);
             
-            if (update_time)
-                lv_label_set_text_fmt(curTime_label, "%02d:%02d", time / 60, time % 60);
+            if (update_time && changed<int32_t>(shown_time, time))
+                time_set(curTime_label, time);
+        }
+        // 设置波形概览，nullptr表示没有缓存
+        void overview_set(const TrackInfo* info) {
+            has_overview = info != nullptr;
+            if (has_overview) {
+                overview_min = info->overview_min;
+                overview_max = info->overview_max;
+            }
+            lv_obj_invalidate(progress_row);
+        }
+        void overview_draw(lv_layer_t* layer) const {
+            if (!has_overview)
+                return;
+            lv_area_t row, bar;
+            lv_obj_get_content_coords(progress_row, &row);
+            lv_obj_get_coords(progress_bar, &bar);
+            const int32_t width = lv_area_get_width(&bar), half = lv_area_get_height(&row) / 2;
+            const int32_t center = row.y1 + half;
+            lv_draw_rect_dsc_t dsc;
+            lv_draw_rect_dsc_init(&dsc);
+            dsc.bg_color = lv_color_hex(0xDDDDDD);
+            for (size_t i = 0; i < TrackInfo::overview_bins; ++i) {
+                lv_area_t a;
+                a.x1 = bar.x1 + static_cast<int32_t>(i * width / TrackInfo::overview_bins);
+                a.x2 = std::max(a.x1, bar.x1 + static_cast<int32_t>((i + 1) * width / TrackInfo::overview_bins) - 1);
+                a.y1 = center - overview_max[i] * half / 128;
+                a.y2 = center - overview_min[i] * half / 128;
+                lv_draw_rect(layer, &dsc, &a);
+            }
         }
         void songName_set(std::string_view name) {
-            lv_label_set_text(songName_label, name.data());
+            if (name != lv_label_get_text(songName_label))
+                lv_label_set_text(songName_label, name.data());
+            marquee_start();
+        }
+        // 重新开始滚动歌曲名，滚完marquee_cycles圈后停在开头
+        // 循环滚动每圈结束时的位置与开头相同，所以只需限制动画的重复次数
+        void marquee_start() {
+            lv_label_set_long_mode(songName_label, LV_LABEL_LONG_SCROLL_CIRCULAR);
+            if (!marquee_cycles)
+                return;
+            if (auto anim = lv_anim_get(songName_label, nullptr))
+                lv_anim_set_repeat_count(anim, marquee_cycles);
         }
         void volume_set(uint8_t vol) {
-            lv_slider_set_value(vol_slider, vol, LV_ANIM_OFF);
+            if (changed<int32_t>(shown_volume, vol))
+                lv_slider_set_value(vol_slider, vol, LV_ANIM_OFF);
         }
         void state_set_playing(bool playing = true) {
+            if (!changed<int8_t>(shown_playing, playing))
+                return;
             if (playing) 
                 lv_label_set_text(lv_obj_get_child(play_btn, 0), LV_SYMBOL_PAUSE);
             else
                 lv_label_set_text(lv_obj_get_child(play_btn, 0), LV_SYMBOL_PLAY);
         }
         void state_toggle_playing() {
-            if (lv_label_get_text(lv_obj_get_child(play_btn, 0)) == std::string_view(LV_SYMBOL_PLAY))
-                state_set_playing(true);
-            else
-                state_set_playing(false);
+            state_set_playing(shown_playing != 1);
         }
         // 更新播放模式按钮显示
+        // 睡眠定时剩余分钟数，0表示未定时
+        void sleep_set(uint32_t minutes) {
+            if (!changed<int32_t>(shown_sleep, minutes))
+                return;
+            auto label = lv_obj_get_child(sleep_btn, 0);
+            if (minutes)
+                lv_label_set_text_fmt(label, "%u", static_cast<unsigned>(minutes));
+            else
+                lv_label_set_text(label, LV_SYMBOL_POWER);
+        }
         void mode_set_display(PlayMode mode) {
+            if (!changed<int8_t>(shown_mode, static_cast<int8_t>(mode)))
+                return;
             auto mode_label = lv_obj_get_child(mode_btn, 0);
             switch (mode) {
                 case PlayMode::SEQUENTIAL:
@@ -427,24 +578,636 @@ private:
     bool is_playing{};
     size_t current_song_index{0};
     PlayMode current_play_mode{PlayMode::SEQUENTIAL}; // 默认顺序播放
+    std::atomic<bool> normalize{}; // 响度归一化
     mutable std::mutex volume_mutex, state_mutex, song_mutex;
     mutable std::condition_variable cv;
-    std::function<void()> lv_lock = []{}, lv_unlock = []{}; // lvgl互斥锁
+    Lock lv_mutex{}; // lvgl互斥锁
 
-    Playlist playlist;
-    Audio song;
-    std::shared_ptr<AudioDevice> device;
+    Playlist playlist;  // 扫描顺序，扫描后不再改变
+    std::vector<uint16_t> order; // 播放顺序，元素为playlist的下标；切换模式只重排下标，不复制字符串
+    Source song;
+    std::shared_ptr<Device> device;
 
     bool playBuffer{};
-    int16_t buffer[2][8192];
+    // 两个半区连续存放，循环模式下整体交给DMA；数组大小即缓冲区的RAM预算
+    static constexpr size_t max_period = 8192; // 每个半区最多的采样点数
+    static constexpr size_t min_period = 1024;
+    int16_t buffer[2 * max_period];
+    size_t period{max_period};      // 当前每个半区的采样点数
+    size_t next_period{max_period}; // PeriodTuner选定的长度，循环模式在下一次启动DMA时生效
+    size_t half_stride{max_period}; // 后半区的起始位置，循环模式下等于period
+    uint32_t period_ms{};           // 当前歌曲一个半区的播放时长，短音触发请求的过期时间据此放宽
+    PeriodTuner tuner;
+    // 播放任务的状态，poll()每次调用推进一步
+    enum class Stage : uint8_t {
+        IDLE,       // 未在传输
+        LINEAR,     // 非循环模式，缓冲区已填充，等待上一次传输完成
+        RUNNING,    // 循环模式播放中
+        HOLDING,    // 循环模式暂停中，DMA仍在输出静音
+        DRAINING    // 循环模式已读完，等待最后一段数据播放完毕
+    };
+    Stage stage{Stage::IDLE};
+    bool resuming{};    // 已恢复，等待恢复的半区开始播放
+    bool sem_taken{};   // task_handler()已阻塞获取过信号量
+    bool linear_busy{}; // 非循环模式下已发出的传输尚未确认完成
+    uint32_t hold_seq{}, hold_halves{};
+    unsigned linear_bytes{};
+    uint32_t dma_handled{}; // 循环模式下已处理的DMA半区序号
+    uint16_t filled[2]{};   // 两个半区中有效数据的采样点数
+    uint64_t fill_end_frame{}; // 最近一次读取后歌曲的帧位置，用于判断暂停前是否发生过跳转
+    uint32_t resume_hold_ms{10000}; // 暂停后DMA继续输出静音的时间
+    bool fade_in_pending{};  // 暂停过，下一次填充需要淡入
+    std::chrono::steady_clock::time_point play_requested{};
+    std::optional<std::chrono::steady_clock::time_point> sleep_deadline; // 睡眠定时的停止时刻
+    uint32_t sleep_fade_ms{30000}; // 停止前的淡出时长
+    bool sleep_expired{};   // 淡出到零的缓冲区已填充，播放完毕后关闭
+    bool sleep_draining{};  // 循环模式：淡出到零的半区正在播放，下一个DMA事件时关闭
+    float sleep_fade_last{1.0f}; // 上一个缓冲区淡出结束时的增益
+    std::atomic<bool> sleep_closed{}; // 已因睡眠定时关闭歌曲，再次播放时从原处重新打开；后台任务据此停止读卡
+    uint64_t sleep_frame{};
+    int32_t hw_gain_step{-1}, hw_gain_written{-1}; // 硬件音量寄存器的当前值与已写入值，-1表示尚未设置
+    uint8_t progress_update_counter{};
+    std::atomic<uint32_t> fill_seq{}; // 已完成的读取次数，供后台任务避开播放线程的读取
+    static constexpr size_t underrun_fade_len = 256; // 欠载恢复时的淡入长度（采样点）
+    static constexpr size_t pause_margin = 1024; // 暂停时正在播放的半区保留的采样点，留给DMA读取位置之后的淡出
+    Stats stats{}; // 播放线程独占，每次poll()结束时整体发布到stats_out
+    mutable TripleBuffer<Stats> stats_out;
+    mutable std::mutex stats_read_mutex; // 只在读者之间互斥，播放线程发布时不等待
+    std::atomic<uint32_t> commands_dropped{}; // 由LVGL线程的post()计数
+    // 断电续播：状态有变化时至少间隔state_min_interval才写入，播放中每state_position_interval更新一次位置，暂停时立即写入
+    static constexpr auto state_min_interval = std::chrono::seconds(5);
+    static constexpr auto state_position_interval = std::chrono::seconds(60);
+    ResumeStore resume_store;
+    uint32_t shuffle_seed{};
+    bool state_dirty{}, state_save_now{};
+    std::chrono::steady_clock::time_point state_saved_at{};
+    // 播放线程只收集状态交到state_posted，fflush/fsync由低优先级线程的write_state()完成
+    std::mutex state_post_mutex;
+    ResumeState state_posted;
+    bool state_pending{};
+    std::atomic<uint32_t> state_writes{};
+    Playlist playlist_posted; // post_playlist()交来的曲库，由state_mutex保护
+    std::atomic<bool> playlist_pending{};
+    bool play_after_playlist{}; // 续播的歌曲在曲库交来之前播完，交来后接着播放下一首
+    std::chrono::steady_clock::time_point init_at{}; // first_sample_us的起点
+    bool first_sample_done{};
+    Mixer mixer;
+    Equalizer equalizer;
+    Spectrum spectrum;
+    LevelMeter level_meter;
+    SpscQueue<Command, 16> commands;
 
-    unsigned fill_buffer() {
-        auto& buf = buffer[!playBuffer];
-        playBuffer = !playBuffer;
-        std::lock_guard song_lk(song_mutex);
-        auto bytesRead = song.read(reinterpret_cast<uint8_t*>(buf), sizeof buf);
+    // 在播放线程中执行UI投递的命令
+    void process_commands() {
+        while (auto cmd = commands.pop()) {
+            switch (cmd->type) {
+                case Command::Type::TOGGLE: toggle_play_pause(); break;
+                case Command::Type::PLAY: play(); break;
+                case Command::Type::PAUSE: pause(); break;
+                case Command::Type::PREV: prev_song(); break;
+                case Command::Type::NEXT: next_song(); break;
+                case Command::Type::LOAD: load(cmd->arg); break;
+                case Command::Type::SEEK: seek(cmd->arg); break;
+                case Command::Type::VOLUME: set_volume(cmd->arg); break;
+                case Command::Type::MODE: switch_play_mode(); break;
+                case Command::Type::SLEEP: set_sleep_timer(cmd->arg); break;
+            }
+            const uint32_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - cmd->posted).count();
+            stats.command_latency_us = latency;
+            stats.command_latency_max_us = std::max(stats.command_latency_max_us, latency);
+        }
+    }
+
+    // 读取数据到指定缓冲区并应用音量，有短音时在同一次循环中混入
+    // 音频源支持零拷贝时直接从其视图处理到缓冲区，视图只在持有song_mutex期间有效
+    // 稳态路径，不应申请堆内存，在poll()的AllocGuard检查范围内
+    unsigned fill_buffer(bool index) {
+        Trace::Scope trace("fill_buffer");
+        int16_t* buf = half(index);
+        const unsigned size = period * sizeof *buf;
+        const int16_t* src = buf;
+        unsigned bytesRead;
+        std::unique_lock song_lk(song_mutex);
+        const uint8_t channels = song.num_channels;
+        const uint32_t rate = song.sample_rate;
+        period_ms = rate && channels ? uint64_t(period) * 1000 / (uint64_t(rate) * channels) : 0;
+        const auto read_start = std::chrono::steady_clock::now();
+        if (song.supports_view()) {
+            auto v = song.view(size);
+            bytesRead = v.size();
+            if (reinterpret_cast<uintptr_t>(v.data()) % alignof(int16_t) == 0)
+                src = reinterpret_cast<const int16_t*>(v.data());
+            else
+                std::memcpy(buf, v.data(), bytesRead);
+        } else {
+            bytesRead = song.read(reinterpret_cast<uint8_t*>(buf), size);
+        }
+        tune_period(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - read_start).count(), rate, channels);
+        fill_end_frame = song.tell_frame();
+        if (!song.supports_view())
+            song_lk.unlock();
+        fill_seq.fetch_add(1, std::memory_order_release);
+        process_buffer(src, buf, bytesRead / 2, channels);
+        if (song_lk.owns_lock())
+            song_lk.unlock();
+        spectrum.push(buf, bytesRead / 2, channels);
+        return bytesRead;
+    }
+
+    int16_t* half(bool index) {
+        return buffer + index * half_stride;
+    }
+    // 记录读取耗时，PeriodTuner给出新的半区长度时记入Stats与Trace
+    void tune_period(uint32_t us, uint32_t rate, uint8_t channels) {
+        if (!rate || !channels)
+            return;
+        const uint32_t period_us = uint64_t(period) * 1000000 / (uint64_t(rate) * channels);
+        const size_t want = tuner.record(us, period, period_us, min_period, max_period);
+        stats.read_p99_us = tuner.p99_us();
+        stats.read_max_us = tuner.max_us();
+        if (want != period)
+            set_next_period(want);
+    }
+    void set_next_period(size_t want) {
+        if (want == next_period)
+            return; // 已在等待生效
+        next_period = want;
+        ++stats.period_changes;
+        Trace::counter("period", want);
+    }
+    // 循环模式下填充一个半区，不足部分补零，暂停恢复或欠载后淡入
+    unsigned fill_half(bool index, bool fade_in) {
+        auto bytesRead = fill_buffer(index);
+        std::fill(half(index) + bytesRead / 2, half(index) + period, 0);
+        if (fade_in)
+            Volume::fade(half(index), std::min<size_t>(underrun_fade_len, bytesRead / 2), 0.0f, 1.0f);
+        filled[index] = bytesRead / 2;
         return bytesRead;
     }
+    // 只在播放线程调用
+    void publish_stats() {
+        stats_out.write_buffer() = stats;
+        stats_out.publish();
+    }
+    void record_underrun() {
+        ++stats.underruns;
+        Trace::instant("underrun");
+        set_next_period(std::min(period * 2, max_period)); // 下一次启动DMA时加大半区
+    }
+    // 写入太迟、DMA已在播放的半区：静音并把歌曲回退bytes，这段数据由下一个半区淡入重新读取
+    void drop_late_half(bool index, unsigned bytes) {
+        std::fill_n(half(index), period, 0);
+        filled[index] = 0;
+        fade_in_pending = true;
+        std::lock_guard song_lk(song_mutex);
+        const uint8_t channels = std::max<uint8_t>(song.num_channels, 1);
+        const uint64_t pos = song.tell_frame();
+        if (pos == fill_end_frame) { // 期间有跳转或切歌时不回退
+            const uint64_t back = bytes / 2 / channels;
+            song.seek_frame(pos > back ? pos - back : 0);
+            fill_end_frame = song.tell_frame();
+        }
+    }
+    // 循环模式下暂停：DMA继续运行，index为可写入的半区
+    // 正在播放的半区在pause_margin之后淡出并静音，可写入的半区直接静音，
+    // 歌曲回退到淡出开始处，恢复时从这里淡入，不会丢失或重复声音
+    // 返回保持DMA运行的半区数
+    uint32_t pause_circular(bool index) {
+        int16_t* playing = half(!index);
+        const size_t valid = filled[!index];
+        const size_t start = std::min(pause_margin, valid);
+        const size_t fade = std::min(underrun_fade_len, valid - start);
+        Volume::fade(playing + start, fade, 1.0f, 0.0f);
+        std::fill(playing + start + fade, playing + period, 0);
+        std::fill_n(half(index), period, 0);
+        filled[0] = filled[1] = 0;
+        fade_in_pending = true;
+
+        std::lock_guard song_lk(song_mutex);
+        const uint8_t channels = std::max<uint8_t>(song.num_channels, 1);
+        const uint64_t pos = song.tell_frame();
+        if (pos == fill_end_frame) { // 期间有跳转或切歌时不回退
+            const uint64_t back = (valid - start) / channels;
+            song.seek_frame(pos > back ? pos - back : 0);
+        }
+        const uint64_t halves = uint64_t(resume_hold_ms) * song.sample_rate * channels
+            / (1000 * period);
+        return std::max<uint64_t>(halves, 1); // 至少等淡出播放完
+    }
+    void record_first_sample() {
+        if (std::exchange(first_sample_done, true))
+            return;
+        stats.first_sample_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - init_at).count();
+        Trace::instant("first_sample");
+    }
+    // 按间隔收集当前状态交给write_state()，在poll()完成填充后调用；播放线程不写卡
+    void save_state_if_due() {
+        if (!resume_store.is_open())
+            return;
+        const auto now = std::chrono::steady_clock::now();
+        const auto elapsed = now - state_saved_at;
+        std::unique_lock state_lk(state_mutex);
+        const bool playing = is_playing;
+        state_lk.unlock();
+        const bool due = state_save_now
+            || (state_dirty && elapsed >= state_min_interval)
+            || (playing && elapsed >= state_position_interval);
+        if (!due)
+            return;
+        // write_state()正在取走上一条记录时不等待，下一次poll()再交
+        std::unique_lock post_lk(state_post_mutex, std::try_to_lock);
+        if (!post_lk)
+            return;
+        state_save_now = false;
+
+        ResumeState& st = state_posted;
+        {
+            std::lock_guard song_lk(song_mutex);
+            if (!song.is_valid() && !sleep_closed)
+                return;
+            st.track = song.name;
+            st.frame = song.is_valid() ? song.tell_frame() : sleep_frame;
+        }
+        st.shuffle_seed = shuffle_seed;
+        st.mode = static_cast<uint8_t>(current_play_mode);
+        st.volume = device ? get_volume() : 0;
+        st.playing = playing;
+        state_pending = true;
+        state_dirty = false;
+        state_saved_at = now;
+    }
+    void take_playlist() {
+        std::unique_lock state_lk(state_mutex);
+        Playlist songs = std::move(playlist_posted);
+        playlist_pending.store(false, std::memory_order_relaxed);
+        state_lk.unlock();
+        set_playlist(std::move(songs));
+    }
+    void record_resume() {
+        const uint32_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - play_requested).count();
+        stats.resume_us = us;
+        stats.resume_max_us = std::max(stats.resume_max_us, us);
+    }
+
+    // 睡眠定时剩余的毫秒数，未定时时为nullopt
+    std::optional<int64_t> sleep_remaining_ms(std::chrono::steady_clock::time_point now) const {
+        if (!sleep_deadline)
+            return std::nullopt;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(*sleep_deadline - now).count();
+    }
+    // 淡出曲线：剩余时间占淡出时长比例的平方，末尾下降更平缓
+    float sleep_gain(int64_t remaining_ms) const {
+        if (sleep_fade_ms == 0)
+            return remaining_ms > 0 ? 1.0f : 0.0f;
+        const float x = std::clamp(static_cast<float>(remaining_ms) / sleep_fade_ms, 0.0f, 1.0f);
+        return x * x;
+    }
+    // 对刚填充的缓冲区施加睡眠定时淡出，返回true表示已淡出到零
+    // 增益按填充时刻计算，填充时刻有抖动，所以起点不高于上一个缓冲区的终点，缓冲区之间不会回升
+    bool sleep_fade(int16_t* buf, size_t samples) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto remaining = sleep_remaining_ms(now);
+        if (!remaining || *remaining > int64_t(sleep_fade_ms) + 5000) // 离淡出还远，不必查询格式
+            return false;
+        uint32_t rate{};
+        uint8_t channels{};
+        {
+            std::lock_guard song_lk(song_mutex);
+            rate = song.sample_rate;
+            channels = song.num_channels;
+        }
+        const int64_t duration_ms = rate && channels ? int64_t(samples) * 1000 / (int64_t(rate) * channels) : 0;
+        const float from = std::min(sleep_gain(*remaining), sleep_fade_last);
+        const float to = std::min(sleep_gain(*remaining - duration_ms), from);
+        if (to < 1.0f)
+            Volume::fade(buf, samples, from, to);
+        sleep_fade_last = to;
+        return to == 0.0f;
+    }
+    // 睡眠定时到：停止DMA并关闭歌曲文件，不再读卡，播放线程在task_handler()中等待直到再次播放
+    void sleep_shutdown() {
+        if (stage != Stage::IDLE)
+            device->transmit_stop();
+        stage = Stage::IDLE;
+        linear_busy = false;
+        sleep_deadline.reset();
+        sleep_expired = sleep_draining = false;
+        sleep_fade_last = 1.0f;
+        {
+            std::lock_guard song_lk(song_mutex);
+            if (song.is_valid()) {
+                sleep_frame = song.tell_frame();
+                song.close();
+                sleep_closed = true;
+            }
+        }
+        pause();
+
+        ScopedLock lock(lv_mutex);
+        ui.sleep_set(0);
+    }
+
+    // 开始播放：校验设备与歌曲后启动传输
+    Wait start() {
+        if (!device) {
+            pause();
+            return Wait::COMMAND;
+        }
+        if (sleep_closed) {
+            // 睡眠定时关闭后再次播放，从关闭处继续
+            load(current_song_index);
+            std::lock_guard song_lk(song_mutex);
+            if (song.is_valid())
+                song.seek_frame(sleep_frame);
+        }
+        std::unique_lock song_lk(song_mutex);
+        if (!song.is_valid()) {
+            song_lk.unlock();
+            pause();
+            return Wait::COMMAND;
+        }
+        song_lk.unlock();
+
+        if (!device->is_circular_mode()) {
+            // 信号量只在传输完成时释放：没有未完成的传输时第一个缓冲区直接发送，
+            // 暂停前发出的传输仍未确认时照常等待它完成
+            if (!linear_busy)
+                device->sem_reset(0);
+            stage = Stage::LINEAR;
+            sem_taken = false;
+            half_stride = max_period;
+            return fill_linear();
+        }
+        // 半区长度只在启动DMA时改变，播放中不会因调整而中断
+        period = half_stride = next_period;
+        stats.period = period;
+        // 只预填充前半区即启动DMA，后半区在前半区播放期间填充
+        // 半区状态由DMA事件序号确定，信号量仅用于唤醒
+        device->sem_reset(0);
+        device->dma_reset();
+        dma_handled = 0;
+        resuming = false;
+        const bool resumed = std::exchange(fade_in_pending, false);
+        if (fill_half(false, resumed) == 0) {
+            song_finished();
+            return Wait::NONE;
+        }
+        sleep_fade(half(false), filled[0]);
+        device->transmit(buffer, period * 2);
+        record_first_sample();
+        if (resumed)
+            record_resume();
+        fill_half(true, false);
+        sleep_fade(half(true), filled[1]);
+        stage = Stage::RUNNING;
+        return Wait::DMA;
+    }
+    // 循环模式：每个DMA事件填充刚播放完的半区
+    Wait step_circular(bool playing) {
+        const uint32_t seq = device->dma_sequence();
+        if (seq == dma_handled)
+            return Wait::DMA; // 多余的唤醒
+        const bool index = !(seq & 1); // 刚播放完、可以写入的半区
+        const bool underrun = stage == Stage::RUNNING && seq - dma_handled > 1;
+        const uint32_t last_handled = std::exchange(dma_handled, seq);
+
+        if (stage == Stage::DRAINING) {
+            if (std::exchange(sleep_expired, false)) {
+                // 淡出到零的半区刚开始播放：刚播放完的半区静音，等淡出的半区也播放完毕再关闭，不截断淡出
+                std::fill_n(half(index), period, 0);
+                sleep_draining = true;
+                return Wait::DMA;
+            }
+            if (std::exchange(sleep_draining, false)) {
+                sleep_shutdown(); // 淡出的最后一段已播放完毕
+                return Wait::COMMAND;
+            }
+            // 最后一段数据已播放完毕
+            device->transmit_stop();
+            stage = Stage::IDLE;
+            song_finished();
+            return Wait::NONE;
+        }
+        if (!playing) {
+            if (stage != Stage::HOLDING) {
+                stage = Stage::HOLDING;
+                resuming = false;
+                hold_seq = seq;
+                hold_halves = pause_circular(index);
+                return Wait::DMA;
+            }
+            if (last_handled == hold_seq) {
+                // 淡出的半区已播放完毕：开头为DMA保留的部分也静音，否则保持期间每次回绕都会重放这一小段
+                std::fill_n(half(false), period, 0);
+                std::fill_n(half(true), period, 0);
+            }
+            if (seq - hold_seq >= hold_halves) {
+                device->transmit_stop();
+                stage = Stage::IDLE;
+                return Wait::COMMAND;
+            }
+            return Wait::DMA;
+        }
+        if (resuming) {
+            record_resume(); // 恢复的半区开始播放
+            resuming = false;
+        }
+        if (underrun) {
+            // 填充不及时，DMA已回绕并在重放旧数据：静音正在播放的半区，新数据淡入
+            record_underrun();
+            std::fill_n(half(!index), period, 0);
+        }
+
+        const auto bytesRead = fill_half(index, underrun || std::exchange(fade_in_pending, false));
+        // 填充期间DMA已开始播放这个半区（迟到不足两个半区，下一次调用看不出序号差）：
+        // 开头播放的是旧数据，静音其余部分并回退歌曲，下一个半区从这里淡入
+        // 迟到两个半区以上时由下一次调用按序号差处理
+        if (bytesRead != 0 && device->dma_sequence() - seq == 1) {
+            record_underrun();
+            drop_late_half(index, bytesRead);
+        }
+        if (stage == Stage::HOLDING)
+            resuming = true;
+        sleep_expired = sleep_fade(half(index), bytesRead / 2);
+        // 读完或睡眠定时淡出到零后，等待最后一段数据播放完毕再停止
+        stage = bytesRead == 0 || sleep_expired ? Stage::DRAINING : Stage::RUNNING;
+        if (bytesRead != 0)
+            progress_update();
+        return Wait::DMA;
+    }
+    // 非循环模式：填充下一个缓冲区，等待上一次传输完成后发送
+    // 两个缓冲区按max_period分开存放，可在任意一次填充前改变长度
+    Wait fill_linear() {
+        period = next_period;
+        stats.period = period;
+        linear_bytes = fill_buffer(!playBuffer);
+        if (linear_bytes == 0) {
+            // 不切换缓冲区：playBuffer可能仍在传输，下一首从另一个缓冲区开始填充
+            stage = Stage::IDLE;
+            song_finished();
+            return Wait::NONE;
+        }
+        playBuffer = !playBuffer;
+        sleep_expired = sleep_fade(half(playBuffer), linear_bytes / 2);
+        return linear_busy ? Wait::DMA : Wait::NONE;
+    }
+    Wait step_linear(bool playing) {
+        if (linear_busy) {
+            if (!std::exchange(sem_taken, false) && !sem_try_acquire())
+                return Wait::DMA;
+            linear_busy = false;
+        }
+        if (linear_bytes == 0) {
+            sleep_shutdown(); // 淡出的最后一个缓冲区已播放完毕
+            return Wait::COMMAND;
+        }
+        device->transmit(half(playBuffer), linear_bytes / 2);
+        linear_busy = true;
+        record_first_sample();
+        progress_update();
+        if (std::exchange(sleep_expired, false)) {
+            linear_bytes = 0;
+            return Wait::DMA;
+        }
+        if (!playing) {
+            stage = Stage::IDLE;
+            return Wait::COMMAND;
+        }
+        return fill_linear();
+    }
+    bool sem_try_acquire() {
+        if constexpr (requires(Device& dev) { { dev.sem_try_acquire() } -> std::convertible_to<bool>; })
+            return device->sem_try_acquire();
+        else
+            return false; // 设备不支持非阻塞获取时只能使用task_handler()
+    }
+
+    // 设备是否以硬件寄存器实现音量
+    bool hardware_gain_enabled() const {
+        if constexpr (requires(Device& dev) { dev.gain_set(int32_t{}); })
+            return device->hardware_gain().has_value();
+        else
+            return false;
+    }
+    // 把目标增益逐步写入硬件寄存器，每个缓冲区最多调整ramp_db
+    // 返回软件仍需施加的系数：目标在寄存器范围内时为1，静音时为0
+    float update_hardware_gain() {
+        if constexpr (requires(Device& dev) { dev.gain_set(int32_t{}); }) {
+            const auto& hw = *device->hardware_gain();
+            const float target = device->volume.get_db();
+            const int32_t top = std::lround((hw.max_db - hw.min_db) / hw.step_db);
+            const int32_t want = std::isfinite(target)
+                ? std::clamp<int32_t>(std::lround((target - hw.min_db) / hw.step_db), 0, top) : 0;
+            if (hw_gain_step < 0) {
+                hw_gain_step = want; // 开始播放前直接设置
+            } else {
+                const int32_t ramp = std::max<int32_t>(1, std::lround(hw.ramp_db / hw.step_db));
+                hw_gain_step += std::clamp(want - hw_gain_step, -ramp, ramp);
+            }
+            if (hw_gain_step != hw_gain_written) {
+                device->gain_set(hw_gain_step);
+                hw_gain_written = hw_gain_step;
+            }
+            if (!std::isfinite(target))
+                return 0.0f;
+            const float residual = target - (hw.min_db + want * hw.step_db);
+            return std::abs(residual) < hw.step_db ? 1.0f : std::pow(10.0f, residual / 20.0f);
+        } else {
+            return device->get_volume_factor();
+        }
+    }
+
+    // 单次循环完成均衡、短音混入、音量、饱和与电平统计，都不需要时退化为Volume::apply
+    // 使用硬件音量且无需软件补足时，没有均衡和混音就不改写采样，电平表只做一次只读的统计
+    // src与dst可以相同（原地处理）
+    void process_buffer(const int16_t* src, int16_t* dst, size_t sz, uint8_t channels) {
+        const auto start = std::chrono::steady_clock::now();
+        const bool eq_on = equalizer.begin();
+        const bool mix_on = mixer.begin(period_ms);
+        const bool meter_on = level_meter.is_enabled();
+        {
+            std::lock_guard volume_lk(volume_mutex);
+            const bool hw = hardware_gain_enabled();
+            const float factor = hw ? update_hardware_gain() : device->get_volume_factor();
+            const bool unity = hw && factor == 1.0f;
+            if (!eq_on && !mix_on && (!meter_on || unity)) {
+                if (!hw)
+                    device->volume.apply(src, dst, sz);
+                else if (!unity)
+                    Volume::scale(src, dst, sz, factor);
+                else if (src != dst)
+                    std::copy(src, src + sz, dst);
+                if (meter_on && channels == 2)
+                    meter_frames<2>(dst, sz);
+                else if (meter_on && channels == 1)
+                    meter_frames<1>(dst, sz);
+            } else if (channels == 2) {
+                process_frames<2>(src, dst, sz, eq_on, mix_on, meter_on, factor);
+            } else if (channels == 1) {
+                process_frames<1>(src, dst, sz, eq_on, mix_on, meter_on, factor);
+            } else {
+                Volume::scale(src, dst, sz, factor);
+            }
+        }
+        const uint32_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        stats.process_us = us;
+        stats.process_max_us = std::max(stats.process_max_us, us);
+    }
+    template<uint8_t C>
+    void process_frames(const int16_t* src, int16_t* dst, size_t sz, bool eq_on, bool mix_on, bool meter_on, float factor) {
+        std::array<int32_t, C> peaks{};
+        std::array<int64_t, C> sums{};
+        for (size_t i = 0; i + C <= sz; i += C) {
+            int32_t frame[C];
+            for (uint8_t c = 0; c < C; ++c)
+                frame[c] = src[i + c];
+            if (eq_on)
+                equalizer.process(frame);
+            const int32_t mix = mix_on ? mixer.next() : 0;
+            for (uint8_t c = 0; c < C; ++c) {
+                const int32_t out = std::clamp<int32_t>((frame[c] + mix) * factor, INT16_MIN, INT16_MAX);
+                dst[i + c] = static_cast<int16_t>(out);
+                peaks[c] = std::max(peaks[c], out < 0 ? -out : out);
+                sums[c] += out * out;
+            }
+        }
+        if (meter_on)
+            level_meter.publish(peaks, sums, sz / C);
+    }
+    // 只读的电平统计，用于采样不需要改写的情况
+    template<uint8_t C>
+    void meter_frames(const int16_t* buf, size_t sz) {
+        std::array<int32_t, C> peaks{};
+        std::array<int64_t, C> sums{};
+        for (size_t i = 0; i + C <= sz; i += C) {
+            for (uint8_t c = 0; c < C; ++c) {
+                const int32_t v = buf[i + c];
+                peaks[c] = std::max(peaks[c], v < 0 ? -v : v);
+                sums[c] += v * v;
+            }
+        }
+        level_meter.publish(peaks, sums, sz / C);
+    }
+
+    // 歌曲结束，根据播放模式切换
+    void song_finished() {
+        if (playlist.empty()) {
+            // 续播的歌曲在曲库交来之前播完：暂停等待曲库，否则每次poll()都会重新开始并立即结束
+            play_after_playlist = true;
+            pause();
+            return;
+        }
+        if (current_play_mode == PlayMode::SINGLE_LOOP) {
+            reload(); // 单曲循环
+        } else {
+            next_song(); // 切换到下一首
+        }
+    }
 
     void load(size_t index) {
         if (playlist.empty())
@@ -453,20 +1216,45 @@ private:
             index = 0;
 
         current_song_index = index;
+        open_song(playlist[order[current_song_index]]);
+    }
+    // 打开歌曲并更新界面，续播时曲库尚未扫描，直接按路径打开
+    bool open_song(std::string_view name) {
+        sleep_closed = false;
+        state_dirty = true;
 
-        std::string_view name = playlist[current_song_index];
         std::unique_lock song_lk(song_mutex);
+        const auto open_start = std::chrono::steady_clock::now();
         if (song.load(name) == -1)
-            return;
+            return false;
+        const uint32_t open_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - open_start).count();
+        stats.open_us = open_us;
+        stats.open_max_us = std::max(stats.open_max_us, open_us);
+        publish_stats(); // 续播等在poll()之外打开歌曲时也能读到
         auto total_time = song.total_time();
+        auto sample_rate = song.sample_rate;
+        auto data_size = song.data_size;
+        const auto info_path = TrackInfo::path_of(song);
         song_lk.unlock();
+        equalizer.set_sample_rate(sample_rate);
+        // 后台分析的缓存：响度归一化与波形概览，没有缓存时不调整
+        TrackInfo info;
+        const bool has_info = info.load_from(info_path, data_size);
+        const float gain = normalize && has_info ? info.gain_db() : 0.0f;
+        if (device) {
+            std::lock_guard volume_lk(volume_mutex);
+            device->volume.set_gain(gain);
+        }
         
-        ScopedLock lock(lv_lock, lv_unlock);
+        ScopedLock lock(lv_mutex);
         // 更新ui
         ui.songName_set(name);
         ui.progress_set_range(total_time);
         ui.progress_update(0);
         ui.playlist_update(current_song_index);
+        ui.overview_set(has_info ? &info : nullptr);
+        return true;
     }
     
     // 根据播放模式获取下一首歌曲索引
@@ -486,44 +1274,87 @@ private:
     }
 
 public:
-    Player() = default;
+    BasicPlayer() = default;
     
-    void init(decltype(device) dev = nullptr, std::tuple<decltype(lv_lock), decltype(lv_unlock)> mutex_funcs = {}, decltype(list_shuffle) shuffle = {}) {
+    // parent为界面所在的屏幕，多个实例可分别放在不同屏幕上，默认为当前活动屏幕
+    void init(decltype(device) dev = nullptr, Lock mutex = {}, decltype(list_shuffle) shuffle = {}, lv_obj_t* parent = nullptr) {
         if (shuffle)
             list_shuffle = shuffle;
         
-        if (mutex_funcs != std::make_tuple(nullptr, nullptr)) {
-            lv_lock = std::get<0>(mutex_funcs);
-            lv_unlock = std::get<1>(mutex_funcs);
-        }
+        lv_mutex = std::move(mutex);
+        init_at = std::chrono::steady_clock::now();
         
         {
-            ScopedLock lock(lv_lock, lv_unlock);
-            ui.init();
+            ScopedLock lock(lv_mutex);
+            ui.init(parent ? parent : lv_screen_active());
             ui.event_init();
-            ui.playlist_load(playlist);
+            ui.playlist_load();
             ui.state_set_playing(is_playing);
             ui.mode_set_display(current_play_mode); // 设置初始播放模式显示
+            spectrum.attach(ui.middle_area);
+            level_meter.attach(ui.level_area);
         }
         
         if (dev)
             bind_device(dev);
         else {
-            ScopedLock lock(lv_lock, lv_unlock);
+            ScopedLock lock(lv_mutex);
             lv_obj_remove_flag(ui.play_btn, LV_OBJ_FLAG_CLICKABLE);
             lv_obj_remove_flag(ui.vol_btn, LV_OBJ_FLAG_CLICKABLE);
         }
     }
     // 搜索歌曲
+    // 音频源提供scan_directory()时由其列出曲目（如PackAudio列出包内曲目），否则扫描.wav文件
+    // 可在任意线程调用，结果交给post_playlist()
+    static Playlist scan_songs(std::string_view path) {
+        if constexpr (requires { Source::scan_directory(path); })
+            return Source::scan_directory(path);
+        else
+            return Audio::scan_directory(path);
+    }
+    // 在播放线程中扫描并替换曲库，扫描期间不填充缓冲区
     void search_songs(std::string_view path) {
-        playlist = Audio::scan_directory(path);
+        set_playlist(scan_songs(path));
+    }
+    // 在其他线程扫描完成后交给播放线程，由下一次poll()替换曲库；续播的歌曲不必等扫描完成即可开始播放
+    void post_playlist(Playlist songs) {
+        {
+            std::lock_guard state_lk(state_mutex);
+            playlist_posted = std::move(songs);
+            playlist_pending.store(true, std::memory_order_release);
+        }
+        cv.notify_one();
+    }
+    // 在播放线程中替换曲库
+    void set_playlist(Playlist songs) {
+        playlist = std::move(songs);
+        if (playlist.size() > UINT16_MAX)
+            playlist.resize(UINT16_MAX);
+        order.resize(playlist.size());
+        std::iota(order.begin(), order.end(), 0);
         if (playlist.empty())
             return;
+        if (current_play_mode == PlayMode::RANDOM)
+            list_shuffle(order, shuffle_seed);
         
-        load(0); // 默认加载第一首歌
+        // 已续播的歌曲仍在曲库中时继续播放，只更新它在列表中的位置
+        std::unique_lock song_lk(song_mutex);
+        const bool loaded = song.is_valid() || sleep_closed;
+        const auto it = loaded ? std::ranges::find(playlist, song.name.view()) : playlist.end();
+        song_lk.unlock();
+        const bool resume = std::exchange(play_after_playlist, false);
+        if (it != playlist.end()) {
+            current_song_index = std::ranges::find(order, uint16_t(it - playlist.begin())) - order.begin();
+            if (resume)
+                song_finished(); // 续播的歌曲已播完，按播放模式切到下一首
+        } else {
+            load(0); // 默认加载第一首歌
+        }
+        if (resume)
+            play();
         
-        ScopedLock lock(lv_lock, lv_unlock);
-        ui.playlist_load(playlist);
+        ScopedLock lock(lv_mutex);
+        ui.playlist_load();
     }
     void reload() {
         load(current_song_index);
@@ -538,54 +1369,37 @@ public:
     }
     
     // 切换播放模式
+    // 只重排order，不复制歌曲路径，也不重新扫描目录
     void switch_play_mode() {
-        // 记住当前播放的歌曲名称
-        std::string current_song;
-        if (current_song_index < playlist.size()) {
-            current_song = playlist[current_song_index];
-        }
-        
         switch (current_play_mode) {
             case PlayMode::SEQUENTIAL:
                 current_play_mode = PlayMode::SINGLE_LOOP;
                 break;
             case PlayMode::SINGLE_LOOP:
                 current_play_mode = PlayMode::RANDOM;
-                // 切换到随机模式时洗牌
-                list_shuffle(playlist);
-                // 找到当前歌曲在洗牌后列表中的新位置
-                if (!current_song.empty()) {
-                    auto it = std::ranges::find(playlist, current_song);
-                    if (it != playlist.end()) {
-                        current_song_index = std::distance(playlist.begin(), it);
-                    }
+                // 切换到随机模式时洗牌，并找到当前歌曲在洗牌后的位置
+                // 每次进入随机模式换一个种子，种子随续播状态保存
+                if (!order.empty()) {
+                    const uint16_t current = order[current_song_index];
+                    shuffle_seed = shuffle_seed * 1664525u + 1013904223u;
+                    list_shuffle(order, shuffle_seed);
+                    current_song_index = std::ranges::find(order, current) - order.begin();
                 }
                 break;
             case PlayMode::RANDOM:
                 current_play_mode = PlayMode::SEQUENTIAL;
-                // 切换回顺序模式时重新扫描文件夹以恢复原始顺序
-                if (!playlist.empty()) {
-                    // 重新扫描当前播放歌曲所在的目录
-                    auto current_path = playlist[current_song_index];
-                    auto last_slash = current_path.find_last_of("/\\");
-                    if (last_slash != std::string::npos) {
-                        auto dir_path = current_path.substr(0, last_slash);
-                        playlist = Audio::scan_directory(dir_path);
-                        // 找到当前歌曲在原始列表中的位置
-                        if (!current_song.empty()) {
-                            auto it = std::ranges::find(playlist, current_song);
-                            if (it != playlist.end()) {
-                                current_song_index = std::distance(playlist.begin(), it);
-                            }
-                        }
-                    }
+                // 切换回顺序模式时恢复扫描顺序
+                if (!order.empty()) {
+                    current_song_index = order[current_song_index];
+                    std::iota(order.begin(), order.end(), 0);
                 }
                 break;
         }
+        state_dirty = true;
         
-        ScopedLock lock(lv_lock, lv_unlock);
+        ScopedLock lock(lv_mutex);
         ui.mode_set_display(current_play_mode);
-        ui.playlist_load(playlist); // 重新加载播放列表UI
+        ui.playlist_load(); // 重新加载播放列表UI
     }
     
     // 获取当前播放模式
@@ -594,22 +1408,28 @@ public:
     }
     // 播放/暂停控制
     void play() {
-        std::lock_guard state_lk(state_mutex);
-        if (is_playing)
-            return;
-        is_playing = true;
+        {
+            std::lock_guard state_lk(state_mutex);
+            if (is_playing)
+                return;
+            is_playing = true;
+            play_requested = std::chrono::steady_clock::now();
+        }
         cv.notify_one();
         
-        ScopedLock lock(lv_lock, lv_unlock);
+        ScopedLock lock(lv_mutex);
         ui.state_set_playing();
     }
     void pause() {
-        std::lock_guard state_lk(state_mutex);
-        if (!is_playing)
-            return;
-        is_playing = false;
+        {
+            std::lock_guard state_lk(state_mutex);
+            if (!is_playing)
+                return;
+            is_playing = false;
+        }
+        state_save_now = true; // 暂停后可能随即断电，由poll()在回退播放位置后写入
 
-        ScopedLock lock(lv_lock, lv_unlock);
+        ScopedLock lock(lv_mutex);
         ui.state_set_playing(false);
     }
     void toggle_play_pause() {
@@ -626,25 +1446,111 @@ public:
     void set_volume(uint8_t vol) {
         std::lock_guard volume_lk(volume_mutex);
         device->set_volume(vol);
+        state_dirty = true;
         
-        ScopedLock lock(lv_lock, lv_unlock);
+        ScopedLock lock(lv_mutex);
         ui.volume_set(vol);
     }
     uint8_t get_volume() const {
         std::lock_guard volume_lk(volume_mutex);
         return device->get_volume();
     }
-    // 注册互斥锁函数
-    void register_mutex(std::function<void()> mutex_lock, std::function<void()> mutex_unlock) {
-        this->lv_lock = mutex_lock;
-        this->lv_unlock = mutex_unlock;
+    // 短音：预加载到内存的单声道PCM，播放时叠加在音乐上，不会额外读取SD卡
+    bool load_sound(uint8_t id, std::span<const int16_t> pcm, uint8_t vol = 100) {
+        return mixer.load(id, pcm, vol);
+    }
+    // 可在任意线程调用，下一个填充的缓冲区开始混入，一至两个半区后出声；暂停中触发的短音过期丢弃，恢复播放时不会补放
+    void play_sound(uint8_t id) {
+        mixer.trigger(id);
+    }
+    void stop_sound(uint8_t id) {
+        mixer.stop(id);
+    }
+    // 后台任务读卡的时机：未在播放，或播放线程刚完成一次读取（距离下一次读取最远）
+    // 每个调用者持有自己的token，返回true时可进行一次小块读取
+    bool io_window(uint32_t& token) const {
+        if (sleep_closed.load(std::memory_order_acquire))
+            return false; // 睡眠定时关闭后不再读卡，直到再次播放
+        {
+            std::lock_guard state_lk(state_mutex);
+            if (!is_playing)
+                return true;
+        }
+        const uint32_t seq = fill_seq.load(std::memory_order_acquire);
+        if (seq == token)
+            return false;
+        token = seq;
+        return true;
+    }
+    // 响度归一化，下一次加载歌曲时生效，需配合TrackAnalyzer生成的缓存
+    void set_normalization(bool enable) {
+        normalize = enable;
+    }
+    // 循环模式下暂停后DMA继续输出静音的时间，期间恢复播放最多等待一个半区
+    // 超时后停止DMA，下一次播放重新启动；0表示淡出后立即停止，在播放线程启动前调用
+    void set_resume_hold(uint32_t ms) {
+        resume_hold_ms = ms;
     }
-    void bind_device(std::shared_ptr<AudioDevice> dev) {
+    // 睡眠定时：minutes分钟后淡出并停止播放，关闭歌曲文件；0为取消。在播放线程调用，UI通过post(SLEEP)
+    void set_sleep_timer(uint16_t minutes) {
+        set_sleep_timer(std::chrono::minutes(minutes));
+    }
+    // 任意时长的睡眠定时，界面上按分钟向上取整显示
+    void set_sleep_timer(std::chrono::milliseconds after) {
+        if (after.count() > 0)
+            sleep_deadline = std::chrono::steady_clock::now() + after;
+        else
+            sleep_deadline.reset();
+        sleep_expired = false;
+        sleep_fade_last = 1.0f;
+
+        ScopedLock lock(lv_mutex);
+        ui.sleep_set(after.count() > 0 ? std::max<int64_t>(1, (after.count() + 59999) / 60000) : 0);
+    }
+    // 睡眠定时到时前的淡出时长
+    void set_sleep_fade(uint16_t seconds) {
+        sleep_fade_ms = seconds * 1000u;
+    }
+    // 歌曲名滚动cycles圈后停止，减少持续的重绘，点击歌曲名可重新滚动；0表示一直滚动，在LVGL线程调用
+    void set_marquee_cycles(uint8_t cycles) {
+        ui.marquee_cycles = cycles;
+    }
+    // 歌曲名和歌单的字体，例如GlyphCache::get_font()，需在init之前调用
+    void set_title_font(const lv_font_t* font) {
+        ui.font = font ? font : &zh;
+    }
+    // 频谱刷新允许占用的CPU比例，超出时自动降低刷新率，需在LVGL线程调用
+    void set_spectrum_budget(uint8_t percent) {
+        spectrum.set_budget(percent);
+    }
+    // 峰值/RMS电平表，默认关闭；开启后每个缓冲区多一次统计，下一个缓冲区生效
+    void set_level_meter(bool enable) {
+        ScopedLock lock(lv_mutex);
+        level_meter.set_enabled(enable);
+    }
+    // 均衡器：可在UI线程直接设置频段或预设，系数无锁地交给播放线程，下一个缓冲区生效
+    Equalizer& get_equalizer() {
+        return equalizer;
+    }
+    // 注册互斥锁
+    void register_mutex(Lock mutex) {
+        lv_mutex = std::move(mutex);
+    }
+    // 兼容以两个函数注册的旧接口，转交给FunctionLock
+    void register_mutex(std::function<void()> mutex_lock, std::function<void()> mutex_unlock)
+        requires std::same_as<Lock, FunctionLock> {
+        register_mutex(FunctionLock{std::move(mutex_lock), std::move(mutex_unlock)});
+    }
+    void bind_device(std::shared_ptr<Device> dev) {
         if (!dev)
             return;
-        device = dev;
+        {
+            std::lock_guard volume_lk(volume_mutex);
+            device = dev;
+            hw_gain_step = hw_gain_written = -1; // 新设备的寄存器状态未知
+        }
 
-        ScopedLock lock(lv_lock, lv_unlock);
+        ScopedLock lock(lv_mutex);
         lv_obj_add_flag(ui.play_btn, LV_OBJ_FLAG_CLICKABLE);
         lv_obj_add_flag(ui.vol_btn, LV_OBJ_FLAG_CLICKABLE);
         ui.volume_set(device->get_volume());
@@ -652,115 +1558,175 @@ public:
 
     void progress_update() {
         // 降低UI更新频率
-        static uint32_t progress_update_counter;
-        uint16_t current_time{};
+        uint32_t current_time{};
         {
             std::lock_guard song_lk(song_mutex);
             current_time = song.current_time();
         }
         if (++progress_update_counter >= 5) {
-            ScopedLock lock(lv_lock, lv_unlock);
+            ScopedLock lock(lv_mutex);
             
             if (!ui.is_dragging_progress)
                 ui.progress_update(current_time);
             else
                 ui.progress_update(current_time, false, true); // 拖动时不更新进度条
+            if (auto remaining = sleep_remaining_ms(std::chrono::steady_clock::now()))
+                ui.sleep_set(std::max<int64_t>(1, (*remaining + 59999) / 60000)); // 向上取整
             progress_update_counter = 0;
         }
     }
-    // 音乐播放任务
-    void task_handler() {
+    // 投递命令，由播放线程在两个缓冲区之间执行，UI线程不会因文件读写或音频锁而阻塞
+    // 队列为单生产者，仅允许LVGL线程调用
+    bool post(typename Command::Type type, uint32_t arg = 0) {
+        if (!commands.push({type, arg, std::chrono::steady_clock::now()})) {
+            commands_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // 播放线程持有state_mutex的时间极短，这里仅为避免暂停等待时丢失唤醒
+        { std::lock_guard state_lk(state_mutex); }
+        cv.notify_one();
+        return true;
+    }
+    // 非阻塞的播放任务：每次调用处理已投递的命令，最多填充一个半区（启动时两个），不会等待
+    // 可在LVGL主循环或事件循环中轮询，省去独立的播放线程；返回值说明下一步在等待什么
+    // 循环模式下根据DMA事件序号推进，不需要信号量；非循环模式需要设备提供sem_try_acquire()
+    Wait poll() {
+        // 所有返回路径都在最后发布统计，get_stats()不读取播放线程正在写的stats
+        struct PublishStats {
+            BasicPlayer& player;
+            ~PublishStats() {
+                player.publish_stats();
+            }
+        } publish_stats{*this};
+        if (playlist_pending.load(std::memory_order_acquire))
+            take_playlist(); // 替换曲库会申请内存，不在下面AllocGuard的检查范围内
+        // 从start()到停止（stage回到IDLE）期间，播放任务的全部工作都在AllocGuard的检查范围内，
+        // 包括播放中执行的切歌、跳转等命令；task_handler()只在poll()之外等待
+        std::optional<AllocGuard::Scope> no_alloc;
+        if (stage != Stage::IDLE)
+            no_alloc.emplace();
+        if (stage != Stage::DRAINING)
+            process_commands(); // 最后一段数据播放期间不处理切歌等命令，与song_finished()不冲突
         std::unique_lock state_lk(state_mutex);
-        cv.wait(state_lk, [this] { return is_playing; }); // 等待播放状态变为true
+        const bool playing = is_playing;
         state_lk.unlock();
-        
-        if (!device) {
-            pause();
-            return;
-        }
+        if (playing && !no_alloc)
+            no_alloc.emplace(); // 即将start()
 
-        std::unique_lock song_lk(song_mutex);
-        if (!song.is_valid()) {
-            song_lk.unlock();
-            pause();
-            return;
+        // 暂停期间到时，直接关闭；播放中则由淡出结束时关闭
+        if (stage == Stage::IDLE || stage == Stage::HOLDING) {
+            if (auto remaining = sleep_remaining_ms(std::chrono::steady_clock::now()); remaining && *remaining <= 0) {
+                sleep_shutdown();
+                save_state_if_due();
+                return Wait::COMMAND;
+            }
         }
-        song_lk.unlock();
 
-        if (device->is_circular_mode()) {
-            // 重置缓冲区状态和信号量
-            playBuffer = true;
-            device->sem_reset(1); // 重置信号量状态
-            
-            auto bytesRead = fill_buffer(); // 预填充缓冲区
-            {
-                std::lock_guard volume_lk(volume_mutex);
-                device->volume.apply(*buffer, sizeof buffer / 2);
-            }
-            if (bytesRead == 0) {
-                device->transmit_stop();
-                if (current_play_mode == PlayMode::SINGLE_LOOP) {
-                    reload(); // 单曲循环
-                } else {
-                    next_song(); // 切换到下一首
+        Wait wait;
+        switch (stage) {
+            case Stage::IDLE: wait = playing ? start() : Wait::COMMAND; break;
+            case Stage::LINEAR: wait = step_linear(playing); break;
+            default: wait = step_circular(playing); break;
+        }
+        save_state_if_due();
+        return wait;
+    }
+    // 阻塞的播放任务，在独立线程中循环调用
+    void task_handler() {
+        switch (poll()) {
+            case Wait::NONE:
+                break;
+            case Wait::COMMAND: {
+                std::unique_lock state_lk(state_mutex);
+                auto ready = [this] { return is_playing || !commands.empty() || playlist_pending; }; // 等待播放、新命令或曲库
+                // 暂停期间睡眠定时到时、或有未写入的续播状态时也需醒来
+                std::optional<std::chrono::steady_clock::time_point> deadline = sleep_deadline;
+                if (state_dirty && resume_store.is_open()) {
+                    const auto save_at = state_saved_at + state_min_interval;
+                    deadline = deadline ? std::min(*deadline, save_at) : save_at;
                 }
-                return;
+                if (deadline)
+                    cv.wait_until(state_lk, *deadline, ready);
+                else
+                    cv.wait(state_lk, ready);
+                break;
             }
-            std::fill(buffer[playBuffer] + bytesRead / 2, buffer[playBuffer] + (sizeof(buffer[playBuffer]) / 2), 0);
-            device->transmit(reinterpret_cast<int16_t*>(buffer), sizeof buffer / 2);
-            while (true) {
+            case Wait::DMA:
                 device->sem_acquire();
-
-                state_lk.lock();
-                if (!is_playing) {
-                    device->transmit_stop();
-                    return;
-                }
-                state_lk.unlock();
-
-                auto bytesRead = fill_buffer();
-                {
-                    std::lock_guard volume_lk(volume_mutex);
-                    device->volume.apply(buffer[playBuffer], bytesRead / 2);
-                }
-                if (bytesRead == 0) {
-                    if (current_play_mode == PlayMode::SINGLE_LOOP) {
-                        reload(); // 单曲循环
-                    } else {
-                        next_song(); // 切换到下一首
-                    }
-                    return;
-                }
-                std::fill(buffer[playBuffer] + bytesRead / 2, buffer[playBuffer] + (sizeof(buffer[playBuffer]) / 2), 0);
-                progress_update();
-            }
-        } else {
-            auto bytesRead = fill_buffer();
-            {
-                std::lock_guard volume_lk(volume_mutex);
-                device->volume.apply(buffer[playBuffer], bytesRead / 2);
-            }
-            if (bytesRead == 0) {
-                if (current_play_mode == PlayMode::SINGLE_LOOP) {
-                    reload(); // 单曲循环
-                } else {
-                    next_song(); // 切换到下一首
-                }
-                return;
-            }
-            
-            device->sem_acquire();
-
-            device->transmit(buffer[playBuffer], bytesRead / 2);
-            progress_update();
+                sem_taken = true;
+                break;
         }
     }
     
+    // 运行统计：最近一次poll()结束时的快照，可在任意线程调用
+    Stats get_stats() const {
+        std::lock_guard stats_lk(stats_read_mutex);
+        stats_out.update();
+        Stats s = stats_out.read_buffer();
+        s.commands_dropped = commands_dropped.load(std::memory_order_relaxed);
+        s.state_saves = state_writes.load(std::memory_order_relaxed);
+        return s;
+    }
+
     // 跳转
-    void seek(uint16_t time_seconds) {
+    void seek(uint32_t time_seconds) {
         std::lock_guard song_lk(song_mutex);
-        song.seek_to(time_seconds);
+        if (song.is_valid())
+            song.seek_to(time_seconds);
+        state_dirty = true;
+    }
+    // 随机播放的种子，例如开机时取自硬件随机数；之后由restore_state()恢复的种子覆盖
+    void set_shuffle_seed(uint32_t seed) {
+        shuffle_seed = seed;
+    }
+    // 断电续播：打开状态文件并恢复上次的歌曲、位置、播放模式、随机种子与音量，上次在播放时继续播放
+    // 直接按路径打开歌曲，不等待曲库扫描，应在init()之后、曲库生效（search_songs()或post_playlist()）之前在播放线程调用
+    // 之后交来的曲库保留当前歌曲；此后状态变化由write_state()写入同一文件
+    bool restore_state(std::string_view path) {
+        if (!resume_store.open(path))
+            return false;
+        state_saved_at = std::chrono::steady_clock::now();
+        const auto& st = resume_store.state();
+        if (!st)
+            return false;
+        if (st->mode <= static_cast<uint8_t>(PlayMode::RANDOM))
+            current_play_mode = static_cast<PlayMode>(st->mode);
+        shuffle_seed = st->shuffle_seed;
+        if (device)
+            set_volume(st->volume);
+        {
+            ScopedLock lock(lv_mutex);
+            ui.mode_set_display(current_play_mode);
+        }
+        if (!open_song(st->track.view()))
+            return false;
+        {
+            std::lock_guard song_lk(song_mutex);
+            song.seek_frame(st->frame);
+        }
+        state_dirty = false;
+        if (st->playing)
+            play();
+        return true;
+    }
+    // 把播放线程收集的续播状态写入存储卡（含fflush/fsync），没有待写入的记录时返回false
+    // 应在一个低优先级线程中定期调用，写卡期间播放线程不等待
+    bool write_state() {
+        ResumeState st;
+        {
+            std::lock_guard post_lk(state_post_mutex);
+            if (!std::exchange(state_pending, false))
+                return false;
+            st = state_posted;
+        }
+        if (!resume_store.save(st))
+            return false;
+        state_writes.store(resume_store.write_count(), std::memory_order_relaxed);
+        return true;
     }
 };
 
+// 兼容运行时回调的默认播放器
+using Player = BasicPlayer<>;
+
 #endif // PLAYER_H
@@ -0,0 +1,160 @@
+#ifndef RESUME_STATE_H
+#define RESUME_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <unistd.h>
+#include "fixed_string.hpp"
+
+// 断电续播的状态：开机后直接打开记录的歌曲并跳转，不必等待曲库扫描
+struct ResumeState {
+    PathString track;       // 歌曲路径
+    uint64_t frame{};       // 播放位置
+    uint32_t shuffle_seed{};
+    uint8_t mode{};         // PlayMode
+    uint8_t volume{};
+    bool playing{};         // 保存时是否在播放
+};
+
+// 状态文件：固定slots个扇区大小的槽位，每次保存轮流写入下一个槽位，只改写一个扇区，
+// 文件长度不变，不更新FAT表；各扇区的写入次数为总次数的1/slots
+// 每条记录带序号与CRC，读取时取序号最大的有效记录，写入中途断电时仍保留上一条
+// 内容与上次相同时不写入
+class ResumeStore {
+public:
+    static constexpr uint8_t slots = 8;
+    static constexpr size_t slot_size = 512;
+private:
+    static constexpr uint32_t magic = 0x53455252; // "RRES"
+    struct Record {
+        uint32_t magic;
+        uint32_t seq;
+        uint64_t frame;
+        uint32_t shuffle_seed;
+        uint8_t mode;
+        uint8_t volume;
+        uint8_t playing;
+        uint8_t track_len;
+        char track[PathString::capacity() + 1];
+        uint8_t reserved[slot_size - 28 - (PathString::capacity() + 1)]; // 28为其余字段的长度
+        uint32_t crc;            // 之前所有字节的CRC32
+    };
+    static_assert(sizeof(Record) == slot_size);
+
+    FILE* file{};
+    uint32_t seq{};
+    std::optional<ResumeState> last;
+    uint32_t writes{};
+
+    static uint32_t crc32(const uint8_t* p, size_t n) {
+        uint32_t crc = 0xFFFFFFFF;
+        while (n--) {
+            crc ^= *p++;
+            for (uint8_t k = 0; k < 8; ++k)
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        return ~crc;
+    }
+    static uint32_t crc_of(const Record& r) {
+        return crc32(reinterpret_cast<const uint8_t*>(&r), offsetof(Record, crc));
+    }
+    static bool same(const ResumeState& a, const ResumeState& b) {
+        return a.track == b.track.view() && a.frame == b.frame && a.shuffle_seed == b.shuffle_seed
+            && a.mode == b.mode && a.volume == b.volume && a.playing == b.playing;
+    }
+public:
+    ResumeStore() = default;
+    ResumeStore(const ResumeStore&) = delete;
+    ResumeStore& operator=(const ResumeStore&) = delete;
+    ~ResumeStore() {
+        close();
+    }
+
+    // 打开状态文件并读取最近一条有效记录，文件不存在时创建
+    bool open(std::string_view path) {
+        close();
+        const PathString name(path);
+        if (name.size() != path.size())
+            return false; // 路径过长
+        if (!(file = fopen(name.c_str(), "r+b"))) {
+            if (!(file = fopen(name.c_str(), "w+b")))
+                return false;
+            static const Record empty{};
+            for (uint8_t i = 0; i < slots; ++i)
+                fwrite(&empty, sizeof empty, 1, file);
+            fflush(file);
+            fsync(fileno(file));
+            return true;
+        }
+
+        Record r;
+        for (uint8_t i = 0; i < slots; ++i) {
+            if (fseek(file, long(i) * slot_size, SEEK_SET) != 0 || fread(&r, sizeof r, 1, file) != 1)
+                break;
+            if (r.magic != magic || r.crc != crc_of(r) || r.track_len > PathString::capacity())
+                continue;
+            if (last && int32_t(r.seq - seq) <= 0)
+                continue;
+            seq = r.seq;
+            ResumeState s;
+            s.track.assign({r.track, r.track_len});
+            s.frame = r.frame;
+            s.shuffle_seed = r.shuffle_seed;
+            s.mode = r.mode;
+            s.volume = r.volume;
+            s.playing = r.playing;
+            last = s;
+        }
+        return true;
+    }
+    void close() {
+        if (file)
+            fclose(file);
+        file = nullptr;
+        last.reset();
+        seq = 0;
+    }
+    bool is_open() const {
+        return file != nullptr;
+    }
+    // 最近一条有效记录
+    const std::optional<ResumeState>& state() const {
+        return last;
+    }
+    // 写入下一个槽位并同步到存储卡，内容未变时直接返回true
+    bool save(const ResumeState& s) {
+        if (!file)
+            return false;
+        if (last && same(*last, s))
+            return true;
+        Record r{};
+        r.magic = magic;
+        r.seq = seq + 1;
+        r.frame = s.frame;
+        r.shuffle_seed = s.shuffle_seed;
+        r.mode = s.mode;
+        r.volume = s.volume;
+        r.playing = s.playing;
+        r.track_len = static_cast<uint8_t>(s.track.size());
+        std::memcpy(r.track, s.track.data(), s.track.size());
+        r.crc = crc_of(r);
+        if (fseek(file, long(r.seq % slots) * slot_size, SEEK_SET) != 0 || fwrite(&r, sizeof r, 1, file) != 1)
+            return false;
+        fflush(file);
+        fsync(fileno(file)); // FatFs在f_sync之前不会把不满一个扇区的写入落盘
+        seq = r.seq;
+        last = s;
+        ++writes;
+        return true;
+    }
+    // 实际写入的次数
+    uint32_t write_count() const {
+        return writes;
+    }
+};
+
+#endif // RESUME_STATE_H
@@ -0,0 +1,182 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <numbers>
+#include <lvgl.h>
+#include "triple_buffer.hpp"
+
+// 频谱可视化：播放线程只复制最近一段处理后的采样，FFT与绘制在LVGL线程的定时器中完成
+// 定时器按CPU预算自动降低刷新率，不会影响音频
+class Spectrum {
+public:
+    static constexpr size_t fft_size = 256;
+    static constexpr uint8_t bar_count = 16;
+private:
+    static constexpr uint32_t min_period = 33;  // ms
+    static constexpr uint32_t max_period = 500; // ms
+    static constexpr float floor_db = 10.0f, ceil_db = 80.0f;
+
+    struct Snapshot {
+        std::array<int16_t, fft_size> samples;
+    };
+    TripleBuffer<Snapshot> snapshot;
+    std::atomic<bool> enabled{};
+
+    // 以下只在LVGL线程中访问
+    std::array<int16_t, fft_size / 2> cos_table{}, sin_table{};
+    std::array<int16_t, fft_size> window{};
+    std::array<uint16_t, bar_count + 1> edges{}; // 每根柱对应的频点范围
+    std::array<int32_t, bar_count> bars{}, drawn{}; // 柱高（像素）
+    std::array<int16_t, fft_size> re{}, im{};
+    lv_obj_t* area{};
+    lv_timer_t* timer{};
+    uint32_t period{min_period};
+    uint8_t budget_pct{5}; // 允许占用的CPU比例
+
+    // Q15定点基2 FFT，每级右移一位防止溢出
+    void fft() {
+        for (size_t i = 1, j = 0; i < fft_size; ++i) {
+            size_t bit = fft_size >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j) {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+        for (size_t len = 2; len <= fft_size; len <<= 1) {
+            const size_t step = fft_size / len;
+            for (size_t i = 0; i < fft_size; i += len) {
+                for (size_t j = 0; j < len / 2; ++j) {
+                    const int32_t wr = cos_table[j * step], wi = -sin_table[j * step];
+                    const size_t a = i + j, b = a + len / 2;
+                    const int32_t tr = (re[b] * wr - im[b] * wi) >> 15;
+                    const int32_t ti = (re[b] * wi + im[b] * wr) >> 15;
+                    re[b] = static_cast<int16_t>((re[a] - tr) >> 1);
+                    im[b] = static_cast<int16_t>((im[a] - ti) >> 1);
+                    re[a] = static_cast<int16_t>((re[a] + tr) >> 1);
+                    im[a] = static_cast<int16_t>((im[a] + ti) >> 1);
+                }
+            }
+        }
+    }
+    void bar_area(uint8_t i, int32_t height, lv_area_t& a) const {
+        lv_area_t content;
+        lv_obj_get_content_coords(area, &content);
+        const int32_t w = lv_area_get_width(&content) / bar_count;
+        a.x1 = content.x1 + i * w + 1;
+        a.x2 = a.x1 + w - 3;
+        a.y2 = content.y2;
+        a.y1 = content.y2 - height + 1;
+    }
+    void update() {
+        const auto start = std::chrono::steady_clock::now();
+        const int32_t max_height = lv_obj_get_content_height(area);
+        std::array<int32_t, bar_count> target{};
+        if (snapshot.update()) {
+            const auto& s = snapshot.read_buffer().samples;
+            for (size_t i = 0; i < fft_size; ++i) {
+                re[i] = static_cast<int16_t>((s[i] * window[i]) >> 15);
+                im[i] = 0;
+            }
+            fft();
+            for (uint8_t b = 0; b < bar_count; ++b) {
+                int32_t power = 0;
+                for (size_t k = edges[b]; k < edges[b + 1]; ++k)
+                    power = std::max(power, re[k] * re[k] + im[k] * im[k]);
+                const float db = 10.0f * std::log10(power + 1.0f);
+                target[b] = std::clamp<int32_t>((db - floor_db) / (ceil_db - floor_db) * max_height, 0, max_height);
+            }
+        }
+        // 上升立即跟随，下降逐帧回落；只重绘高度变化的柱
+        const int32_t decay = std::max<int32_t>(max_height / 16, 1);
+        for (uint8_t b = 0; b < bar_count; ++b) {
+            bars[b] = std::max(target[b], bars[b] - decay);
+            if (bars[b] == drawn[b])
+                continue;
+            lv_area_t a;
+            bar_area(b, std::max(bars[b], drawn[b]), a);
+            lv_obj_invalidate_area(area, &a);
+            drawn[b] = bars[b];
+        }
+        // 超出CPU预算时降低刷新率，余量充足时恢复
+        const uint32_t cost_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        if (cost_us * 100 > budget_pct * period * 1000 && period < max_period)
+            period = std::min(period * 2, max_period);
+        else if (cost_us * 400 < budget_pct * period * 1000 && period > min_period)
+            period = std::max(period / 2, min_period);
+        lv_timer_set_period(timer, period);
+    }
+    void draw(lv_layer_t* layer) const {
+        lv_draw_rect_dsc_t dsc;
+        lv_draw_rect_dsc_init(&dsc);
+        dsc.bg_color = lv_color_hex(0x007BFF);
+        dsc.radius = 2;
+        for (uint8_t b = 0; b < bar_count; ++b) {
+            if (drawn[b] <= 0)
+                continue;
+            lv_area_t a;
+            bar_area(b, drawn[b], a);
+            lv_draw_rect(layer, &dsc, &a);
+        }
+    }
+public:
+    Spectrum() {
+        for (size_t i = 0; i < fft_size / 2; ++i) {
+            const double w = 2 * std::numbers::pi * i / fft_size;
+            cos_table[i] = static_cast<int16_t>(std::lround(std::cos(w) * 32767));
+            sin_table[i] = static_cast<int16_t>(std::lround(std::sin(w) * 32767));
+        }
+        for (size_t i = 0; i < fft_size; ++i)
+            window[i] = static_cast<int16_t>(std::lround((0.5 - 0.5 * std::cos(2 * std::numbers::pi * i / (fft_size - 1))) * 32767));
+        // 对数分布的频点范围
+        edges[0] = 1;
+        for (uint8_t b = 1; b <= bar_count; ++b) {
+            const auto edge = static_cast<uint16_t>(std::lround(std::pow(fft_size / 2.0, static_cast<double>(b) / bar_count)));
+            edges[b] = std::max<uint16_t>(edge, edges[b - 1] + 1);
+        }
+        edges[bar_count] = fft_size / 2;
+    }
+
+    // LVGL线程：在area中绘制频谱，需持有LVGL锁
+    void attach(lv_obj_t* obj) {
+        area = obj;
+        lv_obj_add_event_cb(area, [](lv_event_t* e) {
+            static_cast<Spectrum*>(lv_event_get_user_data(e))->draw(lv_event_get_layer(e));
+        }, LV_EVENT_DRAW_MAIN, this);
+        timer = lv_timer_create([](lv_timer_t* t) {
+            static_cast<Spectrum*>(lv_timer_get_user_data(t))->update();
+        }, period, this);
+        enabled = true;
+    }
+    void set_budget(uint8_t percent) {
+        budget_pct = std::clamp<uint8_t>(percent, 1, 100);
+    }
+
+    // 播放线程：提交处理后的采样（交织），取最后fft_size帧并混为单声道
+    void push(const int16_t* samples, size_t sz, uint8_t channels) {
+        if (!enabled.load(std::memory_order_relaxed) || channels == 0)
+            return;
+        const size_t frames = sz / channels;
+        if (frames < fft_size)
+            return;
+        auto& out = snapshot.write_buffer().samples;
+        const int16_t* src = samples + (frames - fft_size) * channels;
+        for (size_t i = 0; i < fft_size; ++i, src += channels) {
+            int32_t sum = 0;
+            for (uint8_t c = 0; c < channels; ++c)
+                sum += src[c];
+            out[i] = static_cast<int16_t>(sum / channels);
+        }
+        snapshot.publish();
+    }
+};
+
+#endif // SPECTRUM_H
@@ -0,0 +1,40 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// 单生产者单消费者无锁环形队列，容量N须为2的幂
+template<typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+    std::array<T, N> items{};
+    std::atomic<size_t> head{}; // 消费者读取位置
+    std::atomic<size_t> tail{}; // 生产者写入位置
+public:
+    // 仅生产者调用，队列满时返回false
+    bool push(const T& item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+            return false;
+        items[t % N] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    // 仅消费者调用
+    std::optional<T> pop() {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return std::nullopt;
+        T item = items[h % N];
+        head.store(h + 1, std::memory_order_release);
+        return item;
+    }
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SPSC_QUEUE_H
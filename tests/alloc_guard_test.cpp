@@ -0,0 +1,108 @@
+// 稳态不申请堆内存：替换malloc/calloc/realloc接到AllocGuard::on_alloc()，operator new与stdio的分配都经过它们
+// 1. 播放两首歌，期间执行切歌、跳转、音量和模式命令，不应有违规分配；散装文件与打包曲库各一次
+//    切歌时打开文件由文件系统申请的内存在AllocGuard::Allow中，不计入；不加Allow时fopen会被检测到
+// 2. 设备的transmit()每次都申请内存：它在fill_buffer()之外、但在播放期间，应被检测到
+#include <cstdlib>
+#include "pack_audio.hpp"
+#include "player.hpp"
+#include "test_support.hpp"
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t n) noexcept {
+    AllocGuard::on_alloc(n);
+    return __libc_malloc(n);
+}
+void* calloc(size_t n, size_t size) noexcept {
+    AllocGuard::on_alloc(n * size);
+    return __libc_calloc(n, size);
+}
+void* realloc(void* p, size_t n) noexcept {
+    AllocGuard::on_alloc(n);
+    return __libc_realloc(p, n);
+}
+}
+
+namespace {
+
+uint32_t handled;
+
+// 非循环模式，传输立即完成，不创建线程
+struct StaticDevice : AudioDeviceBase {
+    StaticDevice() : AudioDeviceBase(false) { set_volume(80); }
+    void sem_acquire() {}
+    bool sem_try_acquire() { return true; }
+    void sem_reset(uint8_t) {}
+    void transmit(int16_t*, uint16_t) {}
+    void transmit_stop() {}
+    void format_set(uint32_t, uint8_t, uint8_t) {}
+};
+
+struct AllocatingDevice : StaticDevice {
+    void transmit(int16_t*, uint16_t) {
+        void* p = std::malloc(64);
+        asm volatile("" : : "r"(p) : "memory"); // 不让编译器省去这次分配
+        std::free(p);
+    }
+};
+
+template<typename Device, typename Source = Audio>
+uint32_t play(const std::string& dir, bool commands) {
+    BasicPlayer<Device, FunctionLock, Source> player;
+    player.init(std::make_shared<Device>());
+    player.search_songs(dir);
+    AllocGuard::reset();
+    player.play();
+    for (int i = 0; i < 400; ++i) {
+        if (commands && i % 50 == 25) {
+            using Type = typename BasicPlayer<Device, FunctionLock, Source>::Command::Type;
+            constexpr Type sequence[] = {Type::NEXT, Type::SEEK, Type::VOLUME, Type::MODE, Type::PREV, Type::NEXT, Type::SEEK, Type::VOLUME};
+            player.post(sequence[i / 50], 1);
+        }
+        player.poll();
+    }
+    return AllocGuard::count();
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_alloc_guard_test");
+    std::vector<int16_t> pcm(48000 * 2 / 2);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    CHECK(write_wav(dir / "a.wav", pcm, 48000, 2));
+    CHECK(write_wav(dir / "b.wav", pcm, 48000, 2));
+    const auto pack_dir = dir / "pack";
+    std::filesystem::create_directories(pack_dir);
+    CHECK(write_pack(pack_dir / "music.pak", pcm, 2));
+    AllocGuard::set_handler([](size_t) { ++handled; });
+
+    const uint32_t clean = play<StaticDevice>(dir.string(), true);
+    const uint32_t packed = play<StaticDevice, PackAudio>(pack_dir.string(), true);
+    std::printf("steady state with commands: %u allocations, packed %u\n", clean, packed);
+    CHECK(clean == 0);
+    CHECK(packed == 0);
+    CHECK(handled == 0);
+
+    // 钩子能看到C库内部的分配：区间内不加Allow直接打开文件
+    AllocGuard::reset();
+    {
+        AllocGuard::Scope scope;
+        if (FILE* f = std::fopen((dir / "a.wav").c_str(), "rb"))
+            std::fclose(f);
+    }
+    const uint32_t opened = AllocGuard::count();
+    std::printf("fopen() in scope: %u allocations\n", opened);
+    CHECK(opened > 0);
+    handled = 0;
+
+    const uint32_t leaky = play<AllocatingDevice>(dir.string(), false);
+    std::printf("allocating transmit(): %u allocations, handler called %u times\n", leaky, handled);
+    CHECK(leaky > 0);
+    CHECK(handled == leaky);
+    return test_result();
+}
@@ -0,0 +1,50 @@
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#if __has_include(<x86intrin.h>)
+#include <x86intrin.h>
+#endif
+
+// 主机基准测试的计时：多轮取最小值以减少调度干扰，结果为每次操作的纳秒数与时间戳计数器周期数
+// 周期数在x86上取自TSC（按标称频率计数），其他平台为0；换算到目标MCU时以纳秒数乘主频更可靠
+
+struct Timing {
+    double ns;
+    double cycles;
+};
+
+inline uint64_t cycle_count() {
+#if __has_include(<x86intrin.h>)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 对op()计时，iterations为每轮调用次数
+template<typename F>
+Timing measure(F&& op, uint32_t iterations, uint8_t rounds = 7) {
+    Timing best{1e300, 1e300};
+    for (uint8_t r = 0; r < rounds; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t c0 = cycle_count();
+        for (uint32_t i = 0; i < iterations; ++i)
+            op();
+        const uint64_t c1 = cycle_count();
+        const auto t1 = std::chrono::steady_clock::now();
+        best.ns = std::min(best.ns, std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations);
+        best.cycles = std::min(best.cycles, double(c1 - c0) / iterations);
+    }
+    return best;
+}
+
+// 防止编译器把被测结果优化掉
+template<typename T>
+inline void keep(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif // BENCH_SUPPORT_H
@@ -0,0 +1,87 @@
+// 设备回调与LVGL锁的分发开销：std::function（AudioDevice/FunctionLock）与成员函数（StaticLock）的比较
+// 1. 单次调用的开销  2. 非循环模式下每个缓冲区的poll()总耗时及其中的回调次数
+#include <cstdio>
+#include "player.hpp"
+#include "test_support.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+uint32_t lock_calls;
+void count_lock() { ++lock_calls; }
+void count_unlock() {}
+
+uint32_t device_calls;
+
+// 非循环模式，传输立即完成
+struct StaticDevice : AudioDeviceBase {
+    StaticDevice() : AudioDeviceBase(false) { set_volume(100); }
+    void sem_acquire() { ++device_calls; }
+    bool sem_try_acquire() { ++device_calls; return true; }
+    void sem_reset(uint8_t) { ++device_calls; }
+    void transmit(int16_t*, uint16_t) { ++device_calls; }
+    void transmit_stop() { ++device_calls; }
+    void format_set(uint32_t, uint8_t, uint8_t) {}
+};
+
+std::shared_ptr<AudioDevice> make_function_device() {
+    auto dev = std::make_shared<AudioDevice>(
+        [] { ++device_calls; },
+        [](uint8_t) { ++device_calls; },
+        [](int16_t*, uint16_t) { ++device_calls; },
+        [] { ++device_calls; });
+    dev->sem_try_acquire = [] { ++device_calls; return true; };
+    dev->set_volume(100);
+    return dev;
+}
+
+template<typename P>
+Timing per_buffer(P& player, const std::string& dir, uint32_t& calls_per_buffer) {
+    player.search_songs(dir);
+    player.play();
+    player.poll(); // 启动并填充第一个缓冲区
+    constexpr uint32_t buffers = 2000;
+    lock_calls = device_calls = 0;
+    const auto t = measure([&] { player.poll(); }, buffers, 3);
+    calls_per_buffer = (lock_calls + device_calls) / (3 * buffers);
+    return t;
+}
+
+} // namespace
+
+int main() {
+    // 单次调用
+    auto fdev = make_function_device();
+    StaticDevice sdev;
+    FunctionLock flock{count_lock, count_unlock};
+    StaticLock<count_lock, count_unlock> slock;
+    int16_t data[4]{};
+    constexpr uint32_t calls = 10'000'000;
+    const auto f_call = measure([&] { fdev->transmit(data, 4); flock.lock(); flock.unlock(); }, calls);
+    const auto s_call = measure([&] { sdev.transmit(data, 4); slock.lock(); slock.unlock(); }, calls);
+    keep(device_calls);
+    keep(lock_calls);
+    std::printf("transmit+lock+unlock: std::function %.2f ns (%.1f cycles), static %.2f ns (%.1f cycles)\n",
+        f_call.ns, f_call.cycles, s_call.ns, s_call.cycles);
+
+    // 每个缓冲区
+    const auto dir = test_dir("player_dispatch_bench");
+    std::vector<int16_t> pcm(48000 * 2 * 10);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    write_wav(dir / "song.wav", pcm, 48000, 2);
+
+    uint32_t f_calls = 0, s_calls = 0;
+    BasicPlayer<AudioDevice, FunctionLock> f_player;
+    f_player.init(fdev, flock);
+    const auto f_buf = per_buffer(f_player, dir.string(), f_calls);
+    BasicPlayer<StaticDevice, StaticLock<count_lock, count_unlock>> s_player;
+    s_player.init(std::make_shared<StaticDevice>());
+    const auto s_buf = per_buffer(s_player, dir.string(), s_calls);
+    std::printf("poll() per buffer (%u/%u samples): std::function %.0f ns (%.0f cycles, %u dispatched calls), "
+        "static %.0f ns (%.0f cycles, %u calls)\n",
+        unsigned(f_player.get_stats().period), unsigned(s_player.get_stats().period), f_buf.ns, f_buf.cycles, f_calls, s_buf.ns, s_buf.cycles, s_calls);
+    std::printf("saved per buffer: %.1f cycles by call count, %.0f cycles measured\n",
+        f_calls * (f_call.cycles - s_call.cycles) / 3, f_buf.cycles - s_buf.cycles);
+    return 0;
+}
@@ -0,0 +1,34 @@
+// 均衡器每个采样的开销随频段数的变化（立体声，与Player::process_frames相同的逐帧调用方式）
+#include <cstdio>
+#include <vector>
+#include "equalizer.hpp"
+#include "bench_support.hpp"
+
+int main() {
+    constexpr size_t frames = 4096;
+    std::vector<int16_t> src(frames * 2), dst(frames * 2);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = static_cast<int16_t>((i * 7919) % 60000 - 30000);
+
+    Equalizer eq;
+    eq.set_sample_rate(48000);
+    std::printf("bands  ns/sample  cycles/sample\n");
+    for (uint8_t n = 1; n <= Equalizer::max_bands; ++n) {
+        std::vector<Equalizer::Band> bands;
+        for (uint8_t i = 0; i < n; ++i)
+            bands.push_back({Equalizer::FilterType::PEAK, 100.0f * (i + 1) * (i + 1), 3, 1.0f});
+        eq.set_bands(bands);
+        eq.begin();
+        const auto t = measure([&] {
+            for (size_t i = 0; i < src.size(); i += 2) {
+                int32_t frame[2] = {src[i], src[i + 1]};
+                eq.process(frame);
+                dst[i] = static_cast<int16_t>(frame[0]);
+                dst[i + 1] = static_cast<int16_t>(frame[1]);
+            }
+            keep(dst[0]);
+        }, 200);
+        std::printf("%5u  %9.2f  %13.1f\n", n, t.ns / src.size(), t.cycles / src.size());
+    }
+    return 0;
+}
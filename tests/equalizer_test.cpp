@@ -0,0 +1,80 @@
+// 均衡器的余量与前级增益：提升低频的预设处理满幅正弦不削波，频段之间的相对增益仍与设计一致
+// 播放线程切换采样率后系数按新采样率重新计算
+#include <cmath>
+#include <numbers>
+#include "equalizer.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+struct Result {
+    double gain_db;  // 输出与输入的功率比
+    uint32_t clipped; // 超出int16范围的采样数
+};
+
+// 单声道正弦，跳过前100ms的瞬态
+Result run(Equalizer& eq, double freq, double amplitude, uint32_t rate) {
+    eq.begin();
+    double in = 0, out = 0;
+    uint32_t clipped = 0;
+    for (uint32_t n = 0; n < rate; ++n) {
+        const int32_t v = static_cast<int32_t>(std::lround(amplitude * std::sin(2 * std::numbers::pi * freq * n / rate)));
+        int32_t frame[1] = {v};
+        eq.process(frame);
+        if (frame[0] >= INT16_MAX || frame[0] <= INT16_MIN) // 饱和在满幅上也算削波
+            ++clipped;
+        if (n >= rate / 10) {
+            in += double(v) * v;
+            out += double(frame[0]) * frame[0];
+        }
+    }
+    return {10 * std::log10(out / in), clipped};
+}
+
+} // namespace
+
+int main() {
+    constexpr uint32_t rate = 44100;
+    Equalizer eq;
+    eq.set_sample_rate(rate);
+    CHECK(!eq.begin()); // 未设置频段时不处理
+
+    // 低频搁架+6dB：信号不留余量时，60Hz的30000幅度正弦约三分之一的采样被削波
+    eq.set_preset(Equalizer::Preset::BASS);
+    const auto low = run(eq, 60, 30000, rate);
+    const auto high = run(eq, 5000, 30000, rate);
+    std::printf("BASS: 60 Hz %.2f dB (%u clipped), 5 kHz %.2f dB (%u clipped)\n",
+        low.gain_db, low.clipped, high.gain_db, high.clipped);
+    CHECK(low.clipped == 0);
+    CHECK(high.clipped == 0);
+    CHECK(std::abs(low.gain_db - high.gain_db - 6.0) < 0.5); // 相对增益不变
+    CHECK(low.gain_db <= 0.1);                                 // 前级增益抵消了提升
+
+    // 峰值频段的响应
+    const Equalizer::Band peak[] = {{Equalizer::FilterType::PEAK, 1000, 6, 1.0f}};
+    eq.set_bands(peak);
+    const auto center = run(eq, 1000, 30000, rate);
+    const auto away = run(eq, 100, 30000, rate);
+    std::printf("PEAK: 1 kHz %.2f dB, 100 Hz %.2f dB\n", center.gain_db, away.gain_db);
+    CHECK(center.clipped == 0);
+    CHECK(std::abs(center.gain_db - away.gain_db - 6.0) < 0.5);
+
+    // 切换到22.05kHz：峰值仍在1kHz（沿用44.1kHz的系数时会落在500Hz）
+    constexpr uint32_t low_rate = 22050;
+    eq.set_sample_rate(low_rate);
+    const auto moved = run(eq, 1000, 30000, low_rate);
+    const auto half = run(eq, 500, 30000, low_rate);
+    const auto far = run(eq, 100, 30000, low_rate);
+    std::printf("PEAK at %u Hz: 1 kHz %.2f dB, 500 Hz %.2f dB, 100 Hz %.2f dB\n",
+        low_rate, moved.gain_db, half.gain_db, far.gain_db);
+    CHECK(std::abs(moved.gain_db - far.gain_db - 6.0) < 0.5);
+    CHECK(moved.gain_db > half.gain_db + 1.0);
+    eq.set_sample_rate(rate);
+
+    // 只有衰减的预设不需要前级增益
+    const Equalizer::Band cut[] = {{Equalizer::FilterType::PEAK, 1000, -6, 1.0f}};
+    eq.set_bands(cut);
+    const auto pass = run(eq, 100, 10000, rate);
+    CHECK(std::abs(pass.gain_db) < 0.5);
+    return test_result();
+}
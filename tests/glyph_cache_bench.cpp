@@ -0,0 +1,100 @@
+// 歌单滚动时的字形缓存：10000个中文歌名，每帧重绘可见的各行，每个字形先查描述（排版）再取位图（绘制），与LVGL的调用顺序相同
+// 输出不同槽数下每帧的字形耗时、命中率与每帧读SD卡的次数；主机上字体文件在页缓存中，设备上每次未命中还要加上SD卡的读取延迟
+#include <cstdio>
+#include <random>
+#include "glyph_cache.hpp"
+#include "test_support.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+constexpr uint32_t first_char = 0x4E00, font_chars = 6000;
+constexpr uint8_t glyph_size = 16, bpp = 4;
+
+// 16x16、4bpp的字体文件，覆盖first_char起的font_chars个字符
+bool write_font(const std::filesystem::path& path) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    const uint16_t bitmap_size = glyph_size * glyph_size * bpp / 8;
+    const uint32_t header[4] = {0x31464C47, glyph_size | (glyph_size - 2) << 16, bpp, font_chars};
+    std::fwrite(header, sizeof header, 1, f);
+    const uint32_t bitmaps = 16 + font_chars * 16;
+    for (uint32_t i = 0; i < font_chars; ++i) {
+        const uint32_t entry[4] = {first_char + i, bitmaps + i * bitmap_size, uint32_t(glyph_size * 16) | glyph_size << 16 | glyph_size << 24, uint32_t(bitmap_size) << 16};
+        std::fwrite(entry, sizeof entry, 1, f);
+    }
+    std::vector<uint8_t> bitmap(bitmap_size);
+    for (uint32_t i = 0; i < font_chars; ++i) {
+        std::fill(bitmap.begin(), bitmap.end(), uint8_t(i));
+        std::fwrite(bitmap.data(), 1, bitmap.size(), f);
+    }
+    return std::fclose(f) == 0;
+}
+
+// 歌名用字按Zipf分布抽取，接近中文的字频：常用的几百个字占大部分
+std::vector<std::vector<uint32_t>> make_titles(size_t n) {
+    std::mt19937 rng(1);
+    std::vector<double> weights(font_chars);
+    for (uint32_t i = 0; i < font_chars; ++i)
+        weights[i] = 1.0 / (i + 1);
+    std::discrete_distribution<uint32_t> pick(weights.begin(), weights.end());
+    std::uniform_int_distribution<size_t> length(4, 14);
+    std::vector<std::vector<uint32_t>> titles(n);
+    for (auto& t : titles) {
+        t.resize(length(rng));
+        for (auto& c : t)
+            c = first_char + pick(rng);
+    }
+    return titles;
+}
+
+template<size_t Slots>
+void run(const std::filesystem::path& font_path, const std::vector<std::vector<uint32_t>>& titles, uint8_t rows_per_frame, const char* name) {
+    constexpr size_t visible_rows = 10;
+    static GlyphCache<Slots> cache;
+    cache.open(font_path.c_str(), nullptr);
+    const lv_font_t* font = cache.get_font();
+    uint8_t pixels[glyph_size * glyph_size];
+    lv_draw_buf_t draw_buf{};
+    draw_buf.header.stride = glyph_size;
+    draw_buf.data = pixels;
+
+    size_t top = 0, frames = 0;
+    auto frame = [&] {
+        for (size_t r = 0; r < visible_rows; ++r) {
+            for (uint32_t c : titles[(top + r) % titles.size()]) {
+                lv_font_glyph_dsc_t dsc{};
+                dsc.resolved_font = font;
+                if (font->get_glyph_dsc(font, &dsc, c, 0))
+                    keep(font->get_glyph_bitmap(&dsc, &draw_buf));
+            }
+        }
+        top += rows_per_frame;
+        ++frames;
+    };
+    // 从头滚到尾一遍预热，再计时一遍
+    const uint32_t pass = titles.size() / rows_per_frame;
+    const auto t = measure(frame, pass, 2);
+    const auto stats = cache.get_stats();
+    std::printf("%4zu slots, %-14s %6.1f us/frame, hit rate %u%%, %.1f SD reads/frame\n",
+        Slots, name, t.ns / 1000, cache.hit_rate(), double(stats.misses) / frames);
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_glyph_cache_bench");
+    const auto font_path = dir / "title16.glf";
+    if (!write_font(font_path))
+        return 1;
+    const auto titles = make_titles(10000);
+    for (uint8_t speed : {1, 10}) {
+        const char* name = speed == 1 ? "1 row/frame" : "1 page/frame";
+        run<64>(font_path, titles, speed, name);
+        run<128>(font_path, titles, speed, name);
+        run<256>(font_path, titles, speed, name);
+        run<512>(font_path, titles, speed, name);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+// 硬件音量：寄存器范围覆盖目标增益时，播放器不改写读入的采样，开启电平表也只做只读的统计
+// 读入后把缓冲区内的整页设为只读，播放器写入时由SIGSEGV处理函数记录并恢复可写
+// 对照：目标低于寄存器范围时需要软件补足，应能检测到写入，输出按剩余增益缩放
+#include <cmath>
+#include <csignal>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+
+// 被保护的页范围，处理函数中只访问定长数组
+struct Range {
+    uint8_t* begin;
+    size_t len;
+};
+Range guarded[4];
+volatile sig_atomic_t writes;
+struct sigaction previous;
+
+void unprotect_all() {
+    for (auto& r : guarded) {
+        if (r.len)
+            mprotect(r.begin, r.len, PROT_READ | PROT_WRITE);
+        r.len = 0;
+    }
+}
+
+void on_segv(int sig, siginfo_t* info, void* context) {
+    auto addr = static_cast<uint8_t*>(info->si_addr);
+    for (auto& r : guarded) {
+        if (r.len && addr >= r.begin && addr < r.begin + r.len) {
+            writes = writes + 1;
+            unprotect_all();
+            return; // 重新执行写入
+        }
+    }
+    sigaction(sig, &previous, nullptr); // 不是被保护的页，按原来的方式处理
+}
+
+// 读入后保护缓冲区内完整的页，下一次读入同一位置前恢复
+class GuardedAudio : public Audio {
+public:
+    unsigned read(uint8_t buffer[], unsigned size) override {
+        static const uintptr_t page = sysconf(_SC_PAGESIZE);
+        const uintptr_t begin = (reinterpret_cast<uintptr_t>(buffer) + page - 1) & ~(page - 1);
+        const uintptr_t end = (reinterpret_cast<uintptr_t>(buffer) + size) & ~(page - 1);
+        Range* slot = nullptr;
+        for (auto& r : guarded) {
+            if (r.len && reinterpret_cast<uintptr_t>(r.begin) == begin) {
+                mprotect(r.begin, r.len, PROT_READ | PROT_WRITE);
+                r.len = 0;
+            }
+            if (!r.len && !slot)
+                slot = &r;
+        }
+        const unsigned n = Audio::read(buffer, size);
+        if (slot && end > begin) {
+            *slot = {reinterpret_cast<uint8_t*>(begin), end - begin};
+            mprotect(slot->begin, slot->len, PROT_READ);
+        }
+        return n;
+    }
+};
+
+class HwDevice : public SimDevice {
+public:
+    std::atomic<int32_t> reg{-1};
+    HwDevice(float min_db) : SimDevice(false) {
+        set_hardware_gain(HardwareGain{.min_db = min_db, .max_db = 0.0f, .step_db = 0.5f});
+        set_volume(50); // -30dB
+    }
+    void gain_set(int32_t v) {
+        reg = v;
+    }
+};
+
+struct Result {
+    uint32_t writes;
+    int32_t reg;
+    std::vector<int16_t> played;
+};
+
+Result run(const std::filesystem::path& dir, float min_db) {
+    auto dev = std::make_shared<HwDevice>(min_db);
+    BasicPlayer<HwDevice, FunctionLock, GuardedAudio> player;
+    player.init(dev);
+    player.set_level_meter(true);
+    player.search_songs(dir.string());
+
+    std::mutex m;
+    Result result{};
+    dev->played = [&](const int16_t* data, size_t samples) {
+        std::lock_guard lk(m);
+        result.played.insert(result.played.end(), data, data + samples);
+    };
+    writes = 0;
+    std::atomic<bool> done{};
+    std::thread audio_thread([&] {
+        while (!done)
+            player.task_handler();
+    });
+    player.play();
+    std::this_thread::sleep_for(milliseconds(600)); // 短于歌曲，结束时仍在播放，task_handler()不会等待命令
+    result.writes = writes;
+    done = true;
+    audio_thread.join();
+    dev->transmit_stop();
+    unprotect_all();
+    result.reg = dev->reg;
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_hw_gain_test");
+    std::vector<int16_t> pcm(48000 * 2 * 2);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    CHECK(write_wav(dir / "song.wav", pcm, 48000, 2));
+
+    struct sigaction sa{};
+    sa.sa_sigaction = on_segv;
+    sa.sa_flags = SA_SIGINFO;
+    sigaction(SIGSEGV, &sa, &previous);
+
+    // -30dB在寄存器范围内：寄存器为(−30+60)/0.5，采样原样送出
+    const auto hw = run(dir, -60.0f);
+    std::printf("in range: %u writes, register %d, %zu samples played\n", hw.writes, hw.reg, hw.played.size());
+    CHECK(hw.writes == 0);
+    CHECK(hw.reg == 60);
+    CHECK(hw.played.size() > 48000);
+    CHECK(std::equal(hw.played.begin(), hw.played.end(), pcm.begin()));
+
+    // -30dB低于寄存器下限-20dB：寄存器为0，剩余的-10dB由软件施加
+    const auto sw = run(dir, -20.0f);
+    std::printf("below range: %u writes, register %d\n", sw.writes, sw.reg);
+    CHECK(sw.writes > 0);
+    CHECK(sw.reg == 0);
+    const float residual = std::pow(10.0f, -10.0f / 20.0f);
+    bool scaled = !sw.played.empty();
+    for (size_t i = 0; i < sw.played.size(); ++i)
+        scaled = scaled && std::abs(sw.played[i] - pcm[i] * residual) <= 1.0f;
+    CHECK(scaled);
+    return test_result();
+}
@@ -0,0 +1,69 @@
+// 电平表的开销：关闭时音量处理走Volume::apply，开启时走带统计的逐帧循环
+// 1. 单独的Volume::apply  2. 非循环模式下poll()折合到每个采样的总耗时，电平表关闭与开启之差即统计的开销
+#include <cstdio>
+#include "player.hpp"
+#include "test_support.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+uint64_t transferred; // 已传输的采样数
+
+// 非循环模式，传输立即完成
+struct StaticDevice : AudioDeviceBase {
+    StaticDevice() : AudioDeviceBase(false) { set_volume(80); }
+    void sem_acquire() {}
+    bool sem_try_acquire() { return true; }
+    void sem_reset(uint8_t) {}
+    void transmit(int16_t*, uint16_t size) { transferred += size; }
+    void transmit_stop() {}
+    void format_set(uint32_t, uint8_t, uint8_t) {}
+};
+
+// 每个采样的平均耗时：poll()并非每次都填充缓冲区，缓冲区长度也会被PeriodTuner调整，按传输的采样数平均
+template<typename P>
+Timing per_sample(P& player, uint32_t polls) {
+    transferred = 0;
+    const auto t = measure([&] { player.poll(); }, polls, 1);
+    return {t.ns * polls / transferred, t.cycles * polls / transferred};
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_level_meter_bench");
+    std::vector<int16_t> pcm(48000 * 2 * 60); // 足够长，测量期间不切歌
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    write_wav(dir / "song.wav", pcm, 48000, 2);
+
+    BasicPlayer<StaticDevice> player;
+    player.init(std::make_shared<StaticDevice>());
+    player.search_songs(dir.string());
+    player.play();
+    player.poll(); // 启动并填充第一个缓冲区
+
+    constexpr size_t period = 8192;
+    Volume volume;
+    volume.set(80);
+    std::vector<int16_t> buf(period);
+    const auto apply = measure([&] { volume.apply(pcm.data(), buf.data(), period); keep(buf[0]); }, 20000);
+
+    // 交替测量，取各自的最小值
+    constexpr uint32_t polls = 100;
+    Timing off{1e300, 1e300}, on{1e300, 1e300};
+    for (int r = 0; r < 3; ++r) {
+        for (bool meter : {false, true}) {
+            player.set_level_meter(meter);
+            const auto t = per_sample(player, polls);
+            auto& best = meter ? on : off;
+            best.ns = std::min(best.ns, t.ns);
+            best.cycles = std::min(best.cycles, t.cycles);
+        }
+    }
+
+    std::printf("Volume::apply alone: %.2f ns/sample (%.2f cycles/sample)\n", apply.ns / period, apply.cycles / period);
+    std::printf("poll() per sample: meter off %.2f ns (%.2f cycles), meter on %.2f ns (%.2f cycles), overhead %.2f cycles/sample\n",
+        off.ns, off.cycles, on.ns, on.cycles, on.cycles - off.cycles);
+    return 0;
+}
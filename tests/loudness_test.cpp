@@ -0,0 +1,39 @@
+// 积分响度：双声道1kHz正弦的读数与电平一致；多于两个声道的输入按源声道数跨步，只计算前两个声道
+#include <cmath>
+#include <numbers>
+#include <vector>
+#include "loudness.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+// 前两个声道为dbfs电平的1kHz正弦，其余声道为零
+float measure(uint32_t rate, uint8_t channels, double dbfs) {
+    const double amp = std::pow(10.0, dbfs / 20.0) * 32767;
+    const size_t frames = rate * 10;
+    std::vector<int16_t> pcm(frames * channels);
+    for (size_t n = 0; n < frames; ++n) {
+        const auto v = static_cast<int16_t>(amp * std::sin(2 * std::numbers::pi * 1000 * n / rate));
+        for (uint8_t c = 0; c < std::min<uint8_t>(channels, 2); ++c)
+            pcm[n * channels + c] = v;
+    }
+    LoudnessMeter meter;
+    meter.reset(rate, channels);
+    meter.process(pcm.data(), frames);
+    return meter.integrated();
+}
+
+} // namespace
+
+int main() {
+    for (uint32_t rate : {44100u, 48000u}) {
+        const float stereo = measure(rate, 2, -23);
+        const float quad = measure(rate, 4, -23);
+        const float surround = measure(rate, 6, -23);
+        std::printf("%u Hz: stereo %.2f, 4ch %.2f, 6ch %.2f LUFS\n", rate, stereo, quad, surround);
+        CHECK(std::abs(stereo + 23) < 0.3f);
+        CHECK(std::abs(quad - stereo) < 0.05f);
+        CHECK(std::abs(surround - stereo) < 0.05f);
+    }
+    return test_result();
+}
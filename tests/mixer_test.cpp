@@ -0,0 +1,45 @@
+// 短音触发：播放线程及时处理的请求混入，暂停期间（超过两个半区加max_delay_ms未处理）的请求丢弃
+// 半区较长（22.05kHz单声道的8192采样点约371ms）时，正常播放中两次处理之间的触发不会过期
+#include <thread>
+#include "mixer.hpp"
+#include "test_support.hpp"
+
+int main() {
+    static const int16_t beep[] = {1000, 2000, 3000};
+    Mixer mixer;
+    CHECK(mixer.load(0, beep));
+
+    CHECK(!mixer.begin());
+    mixer.trigger(0);
+    CHECK(mixer.begin());
+    CHECK(mixer.next() == 1000);
+    CHECK(mixer.next() == 2000);
+    CHECK(mixer.next() == 3000);
+    CHECK(!mixer.begin());
+
+    // 暂停中触发，恢复播放时已过期
+    mixer.trigger(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(Mixer::max_delay_ms + 50));
+    CHECK(!mixer.begin());
+    CHECK(mixer.next() == 0);
+
+    // 过期的请求不影响之后的触发
+    mixer.trigger(0);
+    CHECK(mixer.begin());
+    CHECK(mixer.next() == 1000);
+    mixer.stop(0);
+    CHECK(!mixer.begin());
+
+    // 长半区：等待超过max_delay_ms但在两个半区之内
+    constexpr uint32_t long_period_ms = 8192 * 1000 / 22050;
+    mixer.trigger(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(long_period_ms));
+    CHECK(mixer.begin(long_period_ms));
+    CHECK(mixer.next() == 1000);
+    mixer.stop(0);
+    CHECK(!mixer.begin(long_period_ms));
+    mixer.trigger(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * long_period_ms + Mixer::max_delay_ms + 50));
+    CHECK(!mixer.begin(long_period_ms));
+    return test_result();
+}
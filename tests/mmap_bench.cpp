@@ -0,0 +1,110 @@
+// MmapAudio与stdio的Audio比较：
+// 1. 顺序读取吞吐：与播放器相同，每块16KB读取后做音量处理；stdio为fread到缓冲区再原地处理，mmap为view()直接处理到输出缓冲区
+// 2. 跳转延迟：随机seek_frame()后用read()读取第一块
+// 分别测量文件在页缓存中（热）与用posix_fadvise丢弃页缓存后（冷）的情况
+#include <cstdio>
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
+#include "audio.hpp"
+#include "mmap_audio.hpp"
+#include "volume.hpp"
+#include "test_support.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+constexpr unsigned chunk = 16384;
+
+void drop_cache(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// 读完整个文件，返回MB/s
+template<typename Source>
+double throughput(const std::filesystem::path& path, bool cold) {
+    if (cold)
+        drop_cache(path);
+    Source audio;
+    Volume volume(80);
+    alignas(4) static uint8_t buf[chunk];
+    alignas(4) static uint8_t out[chunk];
+    const auto t0 = steady_clock::now();
+    audio.load(path.string());
+    uint64_t total = 0;
+    for (;;) {
+        if (audio.supports_view()) {
+            const auto v = audio.view(chunk);
+            if (v.empty())
+                break;
+            volume.apply(reinterpret_cast<const int16_t*>(v.data()), reinterpret_cast<int16_t*>(out), v.size() / 2);
+            total += v.size();
+        } else {
+            const unsigned n = audio.read(buf, chunk);
+            if (!n)
+                break;
+            volume.apply(reinterpret_cast<int16_t*>(buf), n / 2);
+            total += n;
+        }
+        keep(out[0]);
+        keep(buf[0]);
+    }
+    const double s = duration<double>(steady_clock::now() - t0).count();
+    return total / s / 1e6;
+}
+
+// 随机跳转后读取一块，返回每次的平均与最大微秒数
+template<typename Source>
+std::pair<double, double> seek_latency(const std::filesystem::path& path, bool cold, uint64_t frames) {
+    constexpr int seeks = 200;
+    Source audio;
+    audio.load(path.string());
+    std::mt19937_64 rng(2);
+    alignas(4) static uint8_t buf[chunk];
+    double sum = 0, worst = 0;
+    for (int i = 0; i < seeks; ++i) {
+        const uint64_t frame = rng() % frames;
+        if (cold)
+            drop_cache(path);
+        const auto t0 = steady_clock::now();
+        audio.seek_frame(frame);
+        keep(audio.read(buf, chunk)); // 两者都拷贝整块，确保读到了每一页
+        const double us = duration<double, std::micro>(steady_clock::now() - t0).count();
+        sum += us;
+        worst = std::max(worst, us);
+    }
+    return {sum / seeks, worst};
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_mmap_bench");
+    const auto path = dir / "song.wav";
+    std::vector<int16_t> pcm(48000 * 2 * 300); // 5分钟，约55MB
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    if (!write_wav(path, pcm, 48000, 2))
+        return 1;
+    const uint64_t frames = pcm.size() / 2;
+
+    for (bool cold : {false, true}) {
+        const char* cache = cold ? "cold" : "warm";
+        double stdio_mbps = 0, mmap_mbps = 0;
+        for (int r = 0; r < 5; ++r) {
+            stdio_mbps = std::max(stdio_mbps, throughput<Audio>(path, cold));
+            mmap_mbps = std::max(mmap_mbps, throughput<MmapAudio>(path, cold));
+        }
+        const auto [stdio_avg, stdio_max] = seek_latency<Audio>(path, cold, frames);
+        const auto [mmap_avg, mmap_max] = seek_latency<MmapAudio>(path, cold, frames);
+        std::printf("%s: throughput stdio %.0f MB/s, mmap %.0f MB/s; seek+first %u KB stdio %.1f us (max %.0f), mmap %.1f us (max %.0f)\n",
+            cache, stdio_mbps, mmap_mbps, chunk / 1024, stdio_avg, stdio_max, mmap_avg, mmap_max);
+    }
+    return 0;
+}
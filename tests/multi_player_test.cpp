@@ -0,0 +1,107 @@
+// 多个播放器实例同时运行：循环与非循环模式、poll()与task_handler()各两路，每路有自己的设备与DMA线程
+// 检查每路输出与各自的歌曲逐采样相同，并报告每路播放线程的CPU占用
+// 第一路以旧的register_mutex(lock, unlock)接口注册LVGL锁
+#include <ctime>
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+using TestPlayer = BasicPlayer<SimDevice>;
+
+struct Stream {
+    const char* name;
+    bool circular;
+    bool use_poll; // true：poll()轮询；false：task_handler()阻塞
+    std::shared_ptr<SimDevice> device;
+    TestPlayer player;
+    std::vector<int16_t> pcm;
+    std::mutex played_mutex;
+    std::vector<int16_t> played;
+    double cpu_ms{};
+
+    Stream(const char* n, bool c, bool p) : name(n), circular(c), use_poll(p) {}
+};
+
+double thread_cpu_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+} // namespace
+
+int main() {
+    constexpr uint32_t rate = 48000;
+    constexpr uint8_t channels = 2;
+    constexpr auto song_length = milliseconds(1000);
+    Stream streams[] = {
+        {"circular/poll", true, true},
+        {"linear/poll", false, true},
+        {"circular/task", true, false},
+        {"linear/task", false, false},
+    };
+
+    std::atomic<uint32_t> locks{}, unlocks{};
+    const auto root = test_dir("player_multi_test");
+    for (size_t k = 0; k < std::size(streams); ++k) {
+        auto& s = streams[k];
+        const auto dir = root / std::to_string(k);
+        std::filesystem::create_directories(dir);
+        s.pcm.resize(rate * channels * song_length.count() / 1000);
+        for (size_t i = 0; i < s.pcm.size(); ++i)
+            s.pcm[i] = ramp_sample(i + k * 1000);
+        CHECK(write_wav(dir / "song.wav", s.pcm, rate, channels));
+
+        s.device = std::make_shared<SimDevice>(s.circular, rate, channels);
+        s.device->played = [&s](const int16_t* data, size_t samples) {
+            std::lock_guard lk(s.played_mutex);
+            s.played.insert(s.played.end(), data, data + samples);
+        };
+        s.player.init(s.device);
+        if (k == 0)
+            s.player.register_mutex([&locks] { ++locks; }, [&unlocks] { ++unlocks; });
+        s.player.search_songs(dir.string());
+    }
+
+    std::atomic<bool> done{};
+    std::vector<std::thread> threads;
+    for (auto& s : streams) {
+        threads.emplace_back([&s, &done] {
+            const double start = thread_cpu_ms();
+            while (!done) {
+                if (!s.use_poll) {
+                    s.player.task_handler();
+                    continue;
+                }
+                // 事件循环：DMA事件由另一线程产生，这里只按返回值决定是否休眠
+                if (s.player.poll() != TestPlayer::Wait::NONE)
+                    std::this_thread::sleep_for(milliseconds(1));
+            }
+            s.cpu_ms = thread_cpu_ms() - start;
+        });
+        s.player.play();
+    }
+    const auto wall = song_length + milliseconds(600);
+    std::this_thread::sleep_for(wall);
+    done = true;
+    for (auto& t : threads)
+        t.join();
+
+    for (auto& s : streams) {
+        s.device->transmit_stop();
+        const auto stats = s.player.get_stats();
+        std::lock_guard lk(s.played_mutex);
+        std::printf("%-14s played %zu/%zu samples, underruns %u, period %u, cpu %.1f ms per %lld ms (%.2f%%)\n",
+            s.name, s.played.size(), s.pcm.size(), stats.underruns, unsigned(stats.period),
+            s.cpu_ms, static_cast<long long>(wall.count()), 100.0 * s.cpu_ms / wall.count());
+        CHECK(s.played.size() >= s.pcm.size());
+        CHECK(stats.underruns == 0);
+        const size_t n = std::min(s.played.size(), s.pcm.size());
+        CHECK(std::equal(s.pcm.begin(), s.pcm.begin() + n, s.played.begin()));
+    }
+    std::printf("register_mutex: %u lock / %u unlock calls\n", locks.load(), unlocks.load());
+    CHECK(locks > 0 && locks == unlocks);
+    return test_result();
+}
@@ -0,0 +1,139 @@
+// poll()与独立播放线程的比较：同一首歌在循环模式下播放3秒，界面主循环每5ms唤醒一次（模拟lv_timer_handler()的周期）
+// 1. 线程模式：主循环只做界面，另有一个线程循环调用task_handler()
+// 2. poll模式：主循环每次唤醒时调用poll()，没有播放线程
+// 输出各线程的上下文切换次数（getrusage，主动+被动）与栈的最大使用量（线程栈预先填充固定字节，结束后找到最深被改写的位置）
+// 主机上的栈用量包含glibc的stdio等函数，MCU上会小一些，只作两种模式之间的对比
+#include <cstring>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+using BenchPlayer = BasicPlayer<SimDevice>;
+constexpr auto tick = milliseconds(5);
+constexpr auto run_time = milliseconds(3000);
+constexpr size_t stack_size = 256 * 1024;
+constexpr uint8_t stack_fill = 0xA5;
+
+struct ThreadStats {
+    long switches;
+    size_t stack_used;
+};
+
+long context_switches() {
+    rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+// 在预先填充的栈上运行fn，返回该线程的切换次数与栈用量
+class StackThread {
+    std::vector<uint8_t> stack = std::vector<uint8_t>(stack_size, stack_fill);
+    std::function<void()> fn;
+    pthread_t thread{};
+    long switches{};
+
+    static void* entry(void* arg) {
+        auto self = static_cast<StackThread*>(arg);
+        const long before = context_switches();
+        self->fn();
+        self->switches = context_switches() - before;
+        return nullptr;
+    }
+public:
+    explicit StackThread(std::function<void()> f) : fn(std::move(f)) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, stack.data(), stack.size());
+        pthread_create(&thread, &attr, entry, this);
+        pthread_attr_destroy(&attr);
+    }
+    ThreadStats join() {
+        pthread_join(thread, nullptr);
+        // 栈向低地址增长，从底部找到第一个被改写的字节
+        size_t untouched = 0;
+        while (untouched < stack.size() && stack[untouched] == stack_fill)
+            ++untouched;
+        return {switches, stack.size() - untouched};
+    }
+};
+
+// 主循环：每个tick唤醒一次，work()返回后休眠到下一个tick
+template<typename F>
+void ui_loop(F&& work) {
+    auto next = steady_clock::now();
+    const auto end = next + run_time;
+    while (next < end) {
+        work();
+        next += tick;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+struct Result {
+    ThreadStats ui, player;
+    uint32_t underruns;
+};
+
+Result run_threaded(const std::string& dir) {
+    auto dev = std::make_shared<SimDevice>(true);
+    BenchPlayer player;
+    player.init(dev);
+    player.search_songs(dir);
+    std::atomic<bool> done{};
+    StackThread player_thread([&] {
+        while (!done)
+            player.task_handler();
+    });
+    player.play();
+    StackThread ui_thread([] { ui_loop([] {}); });
+    Result r{};
+    r.ui = ui_thread.join();
+    done = true;
+    r.player = player_thread.join();
+    dev->transmit_stop();
+    r.underruns = player.get_stats().underruns;
+    return r;
+}
+
+Result run_polled(const std::string& dir) {
+    auto dev = std::make_shared<SimDevice>(true);
+    BenchPlayer player;
+    player.init(dev);
+    player.search_songs(dir);
+    player.play();
+    StackThread ui_thread([&] {
+        ui_loop([&] {
+            while (player.poll() == BenchPlayer::Wait::NONE) {}
+        });
+    });
+    Result r{};
+    r.ui = ui_thread.join();
+    dev->transmit_stop();
+    r.underruns = player.get_stats().underruns;
+    return r;
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_poll_bench");
+    std::vector<int16_t> pcm(48000 * 2 * 5);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    write_wav(dir / "song.wav", pcm, 48000, 2);
+
+    const auto threaded = run_threaded(dir.string());
+    const auto polled = run_polled(dir.string());
+    std::printf("threaded: ui %ld switches, stack %zu B; player thread %ld switches, stack %zu B; underruns %u\n",
+        threaded.ui.switches, threaded.ui.stack_used, threaded.player.switches, threaded.player.stack_used, threaded.underruns);
+    std::printf("poll():   ui %ld switches, stack %zu B; no player thread; underruns %u\n",
+        polled.ui.switches, polled.ui.stack_used, polled.underruns);
+    std::printf("poll() saves %ld switches over %lld ms; it adds %zd B to the ui stack peak instead of a thread whose stack peaked at %zu B\n",
+        threaded.ui.switches + threaded.player.switches - polled.ui.switches, static_cast<long long>(run_time.count()),
+        static_cast<ssize_t>(polled.ui.stack_used - threaded.ui.stack_used), threaded.player.stack_used);
+    return 0;
+}
@@ -0,0 +1,222 @@
+// 断电续播：
+// 1. ResumeStore轮流写入槽位，内容未变时不写入，重新打开后读到最新记录，最新槽位损坏时退回上一条
+// 2. 播放器续播时不等曲库即从记录的位置开始播放，之后交来的曲库不打断当前歌曲；
+//    暂停后播放线程只收集状态，不写卡，由write_state()写入；淡出后DMA保持运行期间只输出静音
+// 3. 续播的歌曲在曲库交来之前播完：poll()不空转，曲库交来后接着播放下一首
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+using TestPlayer = BasicPlayer<SimDevice>;
+
+void store_test(const std::filesystem::path& path) {
+    {
+        ResumeStore store;
+        CHECK(store.open(path.string()));
+        CHECK(!store.state());
+        for (uint32_t i = 0; i < 11; ++i) {
+            ResumeState st;
+            st.track = "/sdcard/a.wav";
+            st.frame = i * 1000;
+            st.mode = 2;
+            st.volume = 70;
+            st.shuffle_seed = 123;
+            CHECK(store.save(st));
+            CHECK(store.save(st)); // 内容未变，不写入
+        }
+        CHECK(store.write_count() == 11);
+    }
+    {
+        ResumeStore store;
+        CHECK(store.open(path.string()));
+        CHECK(store.state());
+        if (const auto& st = store.state()) {
+            CHECK(st->track == std::string_view("/sdcard/a.wav"));
+            CHECK(st->frame == 10000);
+            CHECK(st->mode == 2 && st->volume == 70 && st->shuffle_seed == 123);
+        }
+    }
+    // 第11条记录在槽位11 % 8 = 3，改写其中一个字节使CRC不符
+    FILE* f = std::fopen(path.c_str(), "r+b");
+    CHECK(f);
+    if (f) {
+        std::fseek(f, 3 * ResumeStore::slot_size + 20, SEEK_SET);
+        std::fputc(0x55, f);
+        std::fclose(f);
+    }
+    ResumeStore store;
+    CHECK(store.open(path.string()));
+    CHECK(store.state() && store.state()->frame == 9000);
+}
+
+// 1秒的a.wav从0.5秒处续播，之后才交来曲库（a.wav、b.wav）
+void finish_before_playlist_test(const std::filesystem::path& dir) {
+    constexpr uint32_t rate = 48000;
+    constexpr uint8_t channels = 2;
+    constexpr int16_t next_level = -1234; // b.wav的采样值，ramp_sample()中没有负数
+    const auto songs = dir / "short";
+    std::filesystem::create_directories(songs);
+    std::vector<int16_t> a(rate * channels), b(rate * channels * 2, next_level);
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = ramp_sample(i);
+    CHECK(write_wav(songs / "a.wav", a, rate, channels));
+    CHECK(write_wav(songs / "b.wav", b, rate, channels));
+    const auto state_path = dir / "short_state.bin";
+    {
+        ResumeStore store;
+        CHECK(store.open(state_path.string()));
+        ResumeState st;
+        st.track = (songs / "a.wav").string();
+        st.frame = rate / 2;
+        st.volume = 100;
+        st.playing = true;
+        CHECK(store.save(st));
+    }
+
+    auto dev = std::make_shared<SimDevice>(true, rate, channels);
+    std::atomic<size_t> next_samples{};
+    dev->played = [&](const int16_t* data, size_t samples) {
+        next_samples += std::count(data, data + samples, next_level);
+    };
+    TestPlayer player;
+    player.init(dev);
+    CHECK(player.restore_state(state_path.string()));
+
+    // 在本线程直接调用poll()，统计要求立即再次调用（Wait::NONE）的次数
+    uint32_t spins = 0;
+    auto run_for = [&](milliseconds d) {
+        const auto end = steady_clock::now() + d;
+        while (steady_clock::now() < end) {
+            if (player.poll() == TestPlayer::Wait::NONE)
+                ++spins;
+            else
+                std::this_thread::sleep_for(milliseconds(1));
+        }
+    };
+    run_for(milliseconds(1000)); // a.wav在约0.5秒后播完
+    const uint32_t spins_waiting = spins;
+    const size_t next_before = next_samples;
+    player.post_playlist(TestPlayer::scan_songs(songs.string()));
+    run_for(milliseconds(500));
+    dev->transmit_stop();
+
+    std::printf("finished before playlist: %u polls returned NONE while waiting, %zu samples of the next song after the playlist\n",
+        spins_waiting, size_t(next_samples));
+    CHECK(spins_waiting < 100);
+    CHECK(next_before == 0);
+    CHECK(next_samples > rate * channels / 4);
+}
+
+} // namespace
+
+int main() {
+    constexpr uint32_t rate = 48000;
+    constexpr uint8_t channels = 2;
+    const auto dir = test_dir("player_resume_state_test");
+    store_test(dir / "store.bin");
+    finish_before_playlist_test(dir);
+
+    const auto songs = dir / "songs";
+    std::filesystem::create_directories(songs);
+    std::vector<int16_t> pcm(rate * channels * 4);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    CHECK(write_wav(songs / "a.wav", pcm, rate, channels));
+    CHECK(write_wav(songs / "b.wav", pcm, rate, channels)); // 曲库的第一首，交来曲库时不应切到这首
+
+    // 上次在a.wav的第1秒处播放
+    const auto state_path = dir / "state.bin";
+    constexpr uint64_t start_frame = rate;
+    {
+        ResumeStore store;
+        CHECK(store.open(state_path.string()));
+        ResumeState st;
+        st.track = (songs / "a.wav").string();
+        st.frame = start_frame;
+        st.volume = 100;
+        st.playing = true;
+        CHECK(store.save(st));
+    }
+
+    auto dev = std::make_shared<SimDevice>(true, rate, channels);
+    std::mutex played_mutex;
+    std::vector<int16_t> played;
+    dev->played = [&](const int16_t* data, size_t samples) {
+        std::lock_guard lk(played_mutex);
+        played.insert(played.end(), data, data + samples);
+    };
+    TestPlayer player;
+    player.init(dev);
+    CHECK(player.restore_state(state_path.string()));
+
+    std::atomic<bool> done{};
+    std::thread audio_thread([&] {
+        while (!done)
+            player.task_handler();
+    });
+    std::this_thread::sleep_for(milliseconds(300));
+    const uint32_t first_sample_us = player.get_stats().first_sample_us;
+
+    // 另一线程扫描后交来曲库（b.wav排在前面），当前歌曲继续
+    std::thread([&] { player.post_playlist(TestPlayer::scan_songs(songs.string())); }).join();
+    std::this_thread::sleep_for(milliseconds(500));
+    size_t before_pause;
+    {
+        std::lock_guard lk(played_mutex);
+        before_pause = played.size();
+    }
+    player.pause();
+    std::this_thread::sleep_for(milliseconds(300));
+
+    // 暂停时立即收集状态，但播放线程不写卡
+    const uint32_t saves_before = player.get_stats().state_saves;
+    uint64_t frame_before = 0;
+    {
+        ResumeStore store;
+        CHECK(store.open(state_path.string()));
+        frame_before = store.state() ? store.state()->frame : 0;
+    }
+    CHECK(player.write_state());
+    CHECK(!player.write_state()); // 没有新的记录
+    const uint32_t saves_after = player.get_stats().state_saves;
+    size_t after_fade;
+    {
+        std::lock_guard lk(played_mutex);
+        after_fade = played.size();
+    }
+    std::this_thread::sleep_for(milliseconds(300));
+    done = true;
+    player.post(TestPlayer::Command::Type::TOGGLE); // 唤醒等待命令的播放线程
+    audio_thread.join();
+    dev->transmit_stop();
+
+    ResumeStore store;
+    CHECK(store.open(state_path.string()));
+    const auto& saved = store.state();
+    std::printf("first sample after %u us, saves %u before write_state(), %u after, saved frame %llu (started at %llu)\n",
+        first_sample_us, saves_before, saves_after,
+        static_cast<unsigned long long>(saved ? saved->frame : 0), static_cast<unsigned long long>(start_frame));
+    CHECK(first_sample_us > 0 && first_sample_us < 200000);
+    CHECK(saves_before == 0);
+    CHECK(frame_before == start_frame);
+    CHECK(saves_after == 1);
+    CHECK(saved && !saved->playing && saved->frame > start_frame);
+    CHECK(saved && saved->track == (songs / "a.wav").string());
+
+    // 交来曲库前后输出都是a.wav从第1秒起的连续数据
+    std::lock_guard lk(played_mutex);
+    const size_t offset = start_frame * channels;
+    const size_t n = std::min(before_pause, pcm.size() - offset);
+    CHECK(n > rate * channels / 2);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i)
+        mismatches += played[i] != pcm[offset + i];
+    CHECK(mismatches == 0);
+
+    // 淡出的半区播放完毕后，DMA回绕时不再重放它开头保留的部分
+    CHECK(played.size() > after_fade);
+    CHECK(std::all_of(played.begin() + after_fade, played.end(), [](int16_t s) { return s == 0; }));
+    return test_result();
+}
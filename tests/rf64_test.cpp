@@ -0,0 +1,88 @@
+// 超过4GB的RF64文件：稀疏写出数据块为6GB的48kHz双声道16位文件，在5GB处写入标记采样
+// 三种读取后端分别检查数据长度与时长、跳转到5GB后的帧位置与读出的标记、跳到结尾后不再读出数据
+#include <cstring>
+#include "audio.hpp"
+#include "mmap_audio.hpp"
+#include "uring_audio.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+constexpr uint64_t data_size = 6ull << 30;
+constexpr uint64_t marker_offset = 5ull << 30;
+constexpr uint8_t marker[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+// 只写头、标记与最后一个字节，其余为文件空洞，不占用磁盘空间
+bool write_sparse_rf64(const std::filesystem::path& path) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    auto u64 = [f](uint64_t v) { std::fwrite(&v, 8, 1, f); };
+    auto u32 = [f](uint32_t v) { std::fwrite(&v, 4, 1, f); };
+    auto u16 = [f](uint16_t v) { std::fwrite(&v, 2, 1, f); };
+    std::fwrite("RF64", 1, 4, f);
+    u32(UINT32_MAX);
+    std::fwrite("WAVE", 1, 4, f);
+    std::fwrite("ds64", 1, 4, f);
+    u32(28);
+    u64(4 + 36 + 24 + 8 + data_size); // riffSize
+    u64(data_size);                   // dataSize
+    u64(data_size / 4);               // sampleCount
+    u32(0);                           // tableLength
+    std::fwrite("fmt ", 1, 4, f);
+    u32(16);
+    u16(1);
+    u16(2);
+    u32(48000);
+    u32(48000 * 4);
+    u16(4);
+    u16(16);
+    std::fwrite("data", 1, 4, f);
+    u32(UINT32_MAX); // 实际长度在ds64中
+    const off_t start = ftello(f);
+    bool ok = fseeko(f, start + off_t(marker_offset), SEEK_SET) == 0
+        && std::fwrite(marker, 1, sizeof marker, f) == sizeof marker
+        && fseeko(f, start + off_t(data_size) - 1, SEEK_SET) == 0
+        && std::fputc(0, f) == 0;
+    return std::fclose(f) == 0 && ok;
+}
+
+template<typename A>
+void check_source(const char* name, const std::filesystem::path& path) {
+    A audio;
+    const int8_t ret = audio.load(path.string());
+    CHECK(ret == 0);
+    if (ret != 0)
+        return;
+    uint8_t buf[sizeof marker]{};
+    audio.seek_frame(marker_offset / 4);
+    const uint64_t frame = audio.tell_frame();
+    const unsigned got = audio.read(buf, sizeof buf);
+    std::printf("%-6s data %llu bytes, %u s, seek to frame %llu, read %u bytes at %u s\n",
+        name, static_cast<unsigned long long>(audio.data_size), audio.total_time(),
+        static_cast<unsigned long long>(frame), got, audio.current_time());
+    CHECK(audio.data_size == data_size);
+    CHECK(audio.total_time() == data_size / (48000 * 4));
+    CHECK(frame == marker_offset / 4);
+    CHECK(got == sizeof marker);
+    CHECK(std::memcmp(buf, marker, sizeof marker) == 0);
+    CHECK(audio.current_time() == (marker_offset + sizeof marker) / 4 / 48000);
+
+    // 跳到结尾（时长取整后可能剩下不足一秒的数据），读完后不越过数据块
+    audio.seek_frame(audio.total_frames());
+    CHECK(audio.tell_frame() == data_size / 4);
+    CHECK(audio.read(buf, sizeof buf) == 0);
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_rf64_test");
+    const auto path = dir / "long.wav";
+    CHECK(write_sparse_rf64(path));
+    check_source<Audio>("stdio", path);
+    check_source<MmapAudio>("mmap", path);
+    check_source<UringAudio>("uring", path);
+    std::filesystem::remove_all(dir);
+    return test_result();
+}
@@ -0,0 +1,115 @@
+// 睡眠定时：淡出曲线按剩余时间比例的平方下降，淡出到零的缓冲区完整播放后才停止DMA；
+// 关闭后播放线程与io_window()把关的后台任务都不再读卡。循环与非循环模式各运行一次
+#include <cmath>
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+constexpr int16_t level = 16000;
+constexpr auto timer = milliseconds(1500);
+constexpr uint16_t fade_s = 1;
+
+class CountingAudio : public Audio {
+public:
+    static inline std::atomic<uint32_t> reads{};
+    unsigned read(uint8_t buffer[], unsigned size) override {
+        ++reads;
+        return Audio::read(buffer, size);
+    }
+};
+
+void run(const std::filesystem::path& dir, bool circular) {
+    const char* mode = circular ? "circular" : "linear";
+    auto dev = std::make_shared<SimDevice>(circular);
+    BasicPlayer<SimDevice, FunctionLock, CountingAudio> player;
+    player.init(dev);
+    player.search_songs(dir.string());
+    player.set_sleep_fade(fade_s);
+
+    std::mutex m;
+    std::vector<int16_t> played;
+    dev->played = [&](const int16_t* data, size_t samples) {
+        std::lock_guard lk(m);
+        played.insert(played.end(), data, data + samples);
+    };
+    std::atomic<bool> done{};
+    std::thread audio_thread([&] {
+        while (!done)
+            player.task_handler();
+    });
+    player.set_sleep_timer(timer); // 在task_handler()处理命令之前设置，与播放线程无竞争
+    player.play();
+
+    // 关闭后：记录读取次数，再等待一段时间确认没有新的读取，后台任务也拿不到读卡许可
+    std::this_thread::sleep_for(timer + milliseconds(500));
+    const uint32_t reads = CountingAudio::reads;
+    size_t played_at_shutdown;
+    {
+        std::lock_guard lk(m);
+        played_at_shutdown = played.size();
+    }
+    uint32_t token = 0, permits = 0;
+    for (int i = 0; i < 50; ++i) {
+        permits += player.io_window(token);
+        std::this_thread::sleep_for(milliseconds(6));
+    }
+    done = true;
+    player.post(BasicPlayer<SimDevice, FunctionLock, CountingAudio>::Command::Type::PAUSE); // 唤醒等待命令的播放线程
+    audio_thread.join();
+    dev->transmit_stop();
+
+    std::lock_guard lk(m);
+    std::printf("%s: %zu samples played, %u reads after shutdown, %u io permits\n",
+        mode, played.size(), CountingAudio::reads - reads, permits);
+    CHECK(CountingAudio::reads == reads);
+    CHECK(permits == 0);
+    CHECK(played.size() == played_at_shutdown);
+    CHECK(!played.empty());
+    if (played.empty())
+        return;
+
+    // 淡出约fade_s秒降到零，距降到零处还有t时增益为(t/fade)^2，且在缓冲区之间不回升
+    // 增益按填充时刻计算，与实际播放时刻可差一个缓冲区，所以t允许一个缓冲区的偏差；
+    // 开始下降的第一个缓冲区在1与终点之间线性插值，不与平方曲线比较
+    const size_t fade_samples = 48000 * 2 * fade_s;
+    size_t start = 0;
+    while (start < played.size() && played[start] >= level)
+        ++start;
+    size_t end = played.size();
+    while (end > start && played[end - 1] == 0)
+        --end;
+    std::printf("%s: fade %zu samples (expected %zu), last sample %d\n", mode, end - start, fade_samples, played.back());
+    CHECK(played.back() == 0); // 最后一个半区淡出到零后完整播放，没有被截断
+    CHECK(std::abs(double(end - start) - fade_samples) < fade_samples * 0.15);
+    uint32_t off_curve = 0, rising = 0;
+    constexpr size_t buffer = 8192;
+    auto curve = [&](double t) {
+        const double x = std::clamp(t / fade_samples, 0.0, 1.0);
+        return x * x;
+    };
+    for (size_t i = start; i < end; ++i) {
+        if (i > start && played[i] > played[i - 1] + 4) // 允许Volume::fade中增益累加的舍入误差
+            ++rising;
+        const double t = double(end - i); // 以降到零处为准
+        if (t > fade_samples - buffer)
+            continue;
+        const double gain = played[i] / double(level);
+        if (gain < curve(t - buffer) - 0.01 || gain > curve(t + buffer) + 0.01)
+            ++off_curve;
+    }
+    CHECK(off_curve == 0);
+    CHECK(rising == 0);
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_sleep_test");
+    std::vector<int16_t> pcm(48000 * 2 * 4, level);
+    CHECK(write_wav(dir / "song.wav", pcm, 48000, 2));
+    run(dir, true);
+    run(dir, false);
+    return test_result();
+}
@@ -0,0 +1,2 @@
+#pragma once
+// 主机测试用的RT-Thread驱动头文件替身，播放器在主机上不需要其中的内容
@@ -0,0 +1,152 @@
+#pragma once
+// 主机测试用的LVGL替身：只提供播放器各模块用到的类型与函数，函数均为空操作，不创建任何控件
+// 例外是显示器事件：lv_display_add_event_cb()登记的回调由lv_display_send_event()调用，供基准测试模拟刷新过程
+#include <cstdint>
+#include <cstddef>
+struct lv_obj_t; struct lv_event_t; struct lv_timer_t; struct lv_layer_t; struct lv_display_t;
+struct lv_image_header_t { uint32_t magic:8; uint32_t cf:8; uint32_t flags:16; uint32_t w:16; uint32_t h:16; uint32_t stride:16; uint32_t reserved_2:16; };
+struct lv_draw_buf_t { lv_image_header_t header; uint32_t data_size; uint8_t* data; void* unaligned_data; const void* handlers; };
+struct lv_color_t { uint8_t r,g,b; };
+struct lv_area_t { int32_t x1,y1,x2,y2; };
+typedef int lv_event_code_t; typedef uint32_t lv_obj_flag_t; typedef uint8_t lv_opa_t;
+typedef void (*lv_event_cb_t)(lv_event_t*);
+typedef void (*lv_timer_cb_t)(lv_timer_t*);
+struct lv_font_glyph_dsc_t { const struct lv_font_t* resolved_font; uint16_t adv_w; uint16_t box_w; uint16_t box_h; int16_t ofs_x; int16_t ofs_y; uint8_t format; uint8_t is_placeholder; union { uint32_t index; const void* src; } gid; void* entry; };
+struct lv_font_t { bool (*get_glyph_dsc)(const lv_font_t*, lv_font_glyph_dsc_t*, uint32_t, uint32_t); const void* (*get_glyph_bitmap)(lv_font_glyph_dsc_t*, lv_draw_buf_t*); void (*release_glyph)(const lv_font_t*, lv_font_glyph_dsc_t*); int32_t line_height; int32_t base_line; uint8_t subpx; uint8_t kerning; int8_t underline_position; int8_t underline_thickness; const void* dsc; const lv_font_t* fallback; void* user_data; };
+struct lv_style_t { uint32_t v[4]; };
+struct lv_draw_rect_dsc_t { lv_color_t bg_color; lv_opa_t bg_opa; int32_t radius; };
+struct lv_mem_monitor_t { size_t total_size, free_cnt, free_size, free_biggest_size, used_cnt, max_used; uint8_t used_pct, frag_pct; };
+enum lv_font_glyph_format_t { LV_FONT_GLYPH_FORMAT_NONE = 0, LV_FONT_GLYPH_FORMAT_A1 = 1, LV_FONT_GLYPH_FORMAT_A2 = 2, LV_FONT_GLYPH_FORMAT_A4 = 4, LV_FONT_GLYPH_FORMAT_A8 = 8 }; enum { LV_FONT_SUBPX_NONE = 0 };
+enum { LV_EVENT_ALL, LV_EVENT_CLICKED, LV_EVENT_PRESSED, LV_EVENT_VALUE_CHANGED, LV_EVENT_RELEASED, LV_EVENT_DRAW_MAIN, LV_EVENT_DRAW_MAIN_BEGIN, LV_EVENT_DRAW_POST, LV_EVENT_INVALIDATE_AREA, LV_EVENT_REFR_START, LV_EVENT_RENDER_START, LV_EVENT_FLUSH_START, LV_EVENT_REFR_READY, LV_EVENT_DELETE, LV_EVENT_SIZE_CHANGED };
+enum { LV_OBJ_FLAG_HIDDEN=1, LV_OBJ_FLAG_CLICKABLE=2, LV_OBJ_FLAG_SCROLLABLE=4, LV_OBJ_FLAG_EVENT_BUBBLE=8 };
+enum { LV_OPA_TRANSP=0, LV_OPA_0=0, LV_OPA_20=51, LV_OPA_50=127, LV_OPA_60=153, LV_OPA_COVER=255 };
+enum { LV_PART_MAIN=0, LV_PART_INDICATOR=0x20000, LV_PART_KNOB=0x30000, LV_STATE_DEFAULT=0, LV_STATE_CHECKED=1 };
+enum { LV_ALIGN_TOP_MID, LV_ALIGN_CENTER, LV_ALIGN_BOTTOM_MID, LV_ALIGN_LEFT_MID, LV_ALIGN_RIGHT_MID, LV_ALIGN_OUT_RIGHT_MID, LV_ALIGN_TOP_LEFT, LV_ALIGN_BOTTOM_LEFT, LV_ALIGN_OUT_BOTTOM_MID, LV_ALIGN_TOP_RIGHT, LV_ALIGN_OUT_BOTTOM_LEFT, LV_ALIGN_OUT_BOTTOM_RIGHT };
+enum { LV_FLEX_FLOW_COLUMN, LV_FLEX_FLOW_ROW }; enum { LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_SPACE_EVENLY };
+enum { LV_TEXT_ALIGN_CENTER }; enum { LV_LABEL_LONG_SCROLL_CIRCULAR, LV_LABEL_LONG_DOT, LV_LABEL_LONG_CLIP }; enum { LV_ANIM_OFF, LV_ANIM_ON };
+enum { LV_RADIUS_CIRCLE = 0x7fff }; enum { LV_SIZE_CONTENT = 0x7ff };
+#define LV_PCT(x) (x)
+#define LV_HOR_RES 320
+#define LV_VER_RES 480
+#define LV_SYMBOL_PREV "p"
+#define LV_SYMBOL_NEXT "n"
+#define LV_SYMBOL_PLAY "P"
+#define LV_SYMBOL_PAUSE "A"
+#define LV_SYMBOL_VOLUME_MAX "V"
+#define LV_SYMBOL_LOOP "L"
+#define LV_SYMBOL_REFRESH "R"
+#define LV_SYMBOL_SHUFFLE "S"
+#define LV_SYMBOL_LIST "l"
+#define LV_SYMBOL_BELL "b"
+#define LV_FONT_DECLARE(n) extern const lv_font_t n;
+#define LV_LABEL_DEF_SCROLL_SPEED 40
+inline lv_obj_t* lv_screen_active() { return {}; }
+inline lv_obj_t* lv_obj_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_label_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_btn_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_button_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_slider_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_list_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_bar_create(lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_list_add_button(lv_obj_t*, const void*, const char*) { return {}; }
+inline void lv_obj_set_size(lv_obj_t*, int32_t, int32_t) {}
+inline void lv_obj_set_width(lv_obj_t*, int32_t) {}
+inline void lv_obj_set_height(lv_obj_t*, int32_t) {}
+inline void lv_obj_align(lv_obj_t*, int, int32_t, int32_t) {}
+inline void lv_obj_align_to(lv_obj_t*, lv_obj_t*, int, int32_t, int32_t) {}
+inline void lv_obj_center(lv_obj_t*) {}
+inline void lv_obj_set_pos(lv_obj_t*, int32_t, int32_t) {}
+inline void lv_obj_add_flag(lv_obj_t*, uint32_t) {}
+inline void lv_obj_remove_flag(lv_obj_t*, uint32_t) {}
+inline bool lv_obj_has_flag(const lv_obj_t*, uint32_t) { return {}; }
+inline void lv_obj_set_flex_flow(lv_obj_t*, int) {}
+inline void lv_obj_set_flex_align(lv_obj_t*, int, int, int) {}
+inline void lv_obj_set_ext_click_area(lv_obj_t*, int32_t) {}
+inline void lv_obj_move_foreground(lv_obj_t*) {}
+inline void lv_obj_move_to_index(lv_obj_t*, int32_t) {}
+inline int32_t lv_obj_get_index(const lv_obj_t*) { return {}; }
+inline void lv_obj_clean(lv_obj_t*) {}
+inline uint32_t lv_obj_get_child_count(const lv_obj_t*) { return {}; }
+inline lv_obj_t* lv_obj_get_child(const lv_obj_t*, int32_t) { return {}; }
+inline lv_obj_t* lv_obj_get_parent(const lv_obj_t*) { return {}; }
+inline void lv_obj_add_event_cb(lv_obj_t*, lv_event_cb_t, int, void*) {}
+struct lv_event_t { int code; void* param; void* user_data; lv_display_t* display; };
+struct lv_display_t {
+    struct Callback { lv_event_cb_t cb; int filter; void* user_data; };
+    Callback callbacks[8];
+    uint8_t count;
+};
+inline void* lv_event_get_user_data(lv_event_t* e) { return e->user_data; }
+inline int lv_event_get_code(lv_event_t* e) { return e->code; }
+inline void* lv_event_get_target(lv_event_t*) { return {}; }
+inline void* lv_event_get_current_target(lv_event_t*) { return {}; }
+inline lv_layer_t* lv_event_get_layer(lv_event_t*) { return {}; }
+inline void* lv_event_get_param(lv_event_t* e) { return e->param; }
+inline int32_t lv_slider_get_value(const lv_obj_t*) { return {}; }
+inline void lv_slider_set_value(lv_obj_t*, int32_t, int) {}
+inline void lv_slider_set_range(lv_obj_t*, int32_t, int32_t) {}
+inline void lv_bar_set_value(lv_obj_t*, int32_t, int) {}
+inline void lv_bar_set_range(lv_obj_t*, int32_t, int32_t) {}
+inline void lv_label_set_text(lv_obj_t*, const char*) {}
+inline void lv_label_set_text_fmt(lv_obj_t*, const char*, ...) {}
+inline const char* lv_label_get_text(const lv_obj_t*) { return ""; }
+inline void lv_label_set_long_mode(lv_obj_t*, int) {}
+inline lv_color_t lv_color_hex(uint32_t) { return {}; }
+inline lv_color_t lv_color_mix(lv_color_t, lv_color_t, uint8_t) { return {}; }
+#define STYLE_FN(n, T) inline void lv_obj_set_style_##n(lv_obj_t*, T, uint32_t) {} inline void lv_style_set_##n(lv_style_t*, T) {}
+STYLE_FN(pad_all, int32_t) STYLE_FN(pad_ver, int32_t) STYLE_FN(pad_hor, int32_t) STYLE_FN(pad_bottom, int32_t) STYLE_FN(pad_top, int32_t) STYLE_FN(pad_row, int32_t) STYLE_FN(pad_column, int32_t) STYLE_FN(border_width, int32_t) STYLE_FN(bg_opa, lv_opa_t) STYLE_FN(radius, int32_t) STYLE_FN(border_color, lv_color_t) STYLE_FN(bg_color, lv_color_t) STYLE_FN(text_font, const lv_font_t*) STYLE_FN(text_align, int) STYLE_FN(anim_duration, uint32_t) STYLE_FN(width, int32_t) STYLE_FN(height, int32_t) STYLE_FN(text_color, lv_color_t)
+inline void lv_style_init(lv_style_t*) {}
+inline void lv_style_reset(lv_style_t*) {}
+inline void lv_obj_add_state(lv_obj_t*, uint32_t) {}
+inline void lv_obj_remove_state(lv_obj_t*, uint32_t) {}
+inline void lv_obj_add_style(lv_obj_t*, const lv_style_t*, uint32_t) {}
+inline lv_timer_t* lv_timer_create(lv_timer_cb_t, uint32_t, void*) { return {}; }
+inline void lv_timer_set_period(lv_timer_t*, uint32_t) {}
+inline void* lv_timer_get_user_data(lv_timer_t*) { return {}; }
+inline void lv_timer_delete(lv_timer_t*) {}
+inline void lv_timer_pause(lv_timer_t*) {}
+inline void lv_timer_resume(lv_timer_t*) {}
+inline void lv_timer_reset(lv_timer_t*) {}
+inline void lv_obj_get_content_coords(const lv_obj_t*, lv_area_t* a) { *a = {}; }
+inline void lv_obj_get_coords(const lv_obj_t*, lv_area_t* a) { *a = {}; }
+inline void lv_obj_invalidate_area(const lv_obj_t*, const lv_area_t*) {}
+inline void lv_obj_invalidate(const lv_obj_t*) {}
+inline int32_t lv_obj_get_content_width(const lv_obj_t*) { return {}; }
+inline int32_t lv_obj_get_content_height(const lv_obj_t*) { return {}; }
+inline int32_t lv_obj_get_width(const lv_obj_t*) { return {}; }
+inline void lv_draw_rect_dsc_init(lv_draw_rect_dsc_t*) {}
+inline void lv_draw_rect(lv_layer_t*, const lv_draw_rect_dsc_t*, const lv_area_t*) {}
+inline uint32_t lv_tick_get() { return {}; }
+inline uint32_t lv_tick_elaps(uint32_t) { return {}; }
+inline void lv_mem_monitor(lv_mem_monitor_t* m) { *m = {}; }
+inline lv_display_t stub_default_display{};
+inline lv_display_t* lv_display_get_default() { return &stub_default_display; }
+inline void lv_display_add_event_cb(lv_display_t* disp, lv_event_cb_t cb, int filter, void* user_data) {
+    if (disp->count < 8)
+        disp->callbacks[disp->count++] = {cb, filter, user_data};
+}
+inline void lv_display_send_event(lv_display_t* disp, int code, void* param) {
+    for (uint8_t i = 0; i < disp->count; ++i) {
+        const auto& c = disp->callbacks[i];
+        if (c.filter != LV_EVENT_ALL && c.filter != code)
+            continue;
+        lv_event_t e{code, param, c.user_data, disp};
+        c.cb(&e);
+    }
+}
+inline void lv_txt_get_size(void*, const char*, const lv_font_t*, int32_t, int32_t, int32_t, int) {}
+inline int32_t lv_area_get_width(const lv_area_t* a) { return a->x2 - a->x1 + 1; }
+inline int32_t lv_area_get_height(const lv_area_t* a) { return a->y2 - a->y1 + 1; }
+struct lv_anim_t; typedef void (*lv_anim_exec_xcb_t)(void*, int32_t);
+inline lv_anim_t* lv_anim_get(void*, lv_anim_exec_xcb_t) { return {}; }
+inline void lv_anim_set_repeat_count(lv_anim_t*, uint32_t) {}
+typedef int lv_color_format_t;
+inline lv_color_format_t lv_display_get_color_format(lv_display_t*) { return {}; }
+inline uint8_t lv_color_format_get_size(lv_color_format_t) { return 2; }
+inline lv_display_t* lv_event_get_target_display(lv_event_t* e) { return e->display; }
+inline uint32_t lv_anim_speed_to_time(uint32_t, int32_t, int32_t) { return {}; }
+inline int32_t lv_obj_get_style_anim_speed(const lv_obj_t*, uint32_t) { return {}; }
+inline const lv_font_t* lv_obj_get_style_text_font(const lv_obj_t*, uint32_t) { return {}; }
+inline int32_t lv_text_get_width(const char*, uint32_t, const lv_font_t*, int32_t) { return {}; }
+inline lv_obj_t* lv_list_add_text(lv_obj_t*, const char*) { return {}; }
+#define LV_SYMBOL_POWER "\xEF\x80\x91"
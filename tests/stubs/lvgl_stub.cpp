@@ -0,0 +1,5 @@
+// 主机测试用的LVGL替身中需要定义的对象
+#include <lvgl.h>
+
+LV_FONT_DECLARE(zh)
+const lv_font_t zh{};
@@ -0,0 +1,109 @@
+// 点按到出声的延迟：界面线程post(TOGGLE)时记下时刻，SimDevice交出已播放的数据时按采样位置换算出它的播放时刻
+// 1. 暂停：从投递到最后一个非零采样播完（淡出结束）
+// 2. 播放：从投递到第一个非零采样开始播放
+// 循环模式分别在暂停保持期内恢复（DMA未停，一个半区内出声）和保持时间为0（每次重新启动DMA）时测量，另测非循环模式
+#include <algorithm>
+#include <numeric>
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+using BenchPlayer = BasicPlayer<SimDevice>;
+using Command = BenchPlayer::Command::Type;
+constexpr int taps = 20;
+
+int64_t now_ns() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// DMA线程写入、界面线程读取的时刻，均为steady_clock纳秒数
+struct Probe {
+    std::atomic<int64_t> sound_posted{}; // 等待出声的投递时刻，0为不在等待
+    std::atomic<int64_t> first_sound{};
+    std::atomic<int64_t> last_sound_end{};
+
+    void played(const int16_t* data, size_t samples, uint32_t rate, uint8_t channels) {
+        const int64_t end = now_ns();
+        auto at = [&](size_t i) { return end - int64_t((samples - i) * 1000000000ull / (uint64_t(rate) * channels)); };
+        const auto first = std::find_if(data, data + samples, [](int16_t s) { return s != 0; });
+        if (first == data + samples)
+            return;
+        const auto last = std::find_if(std::make_reverse_iterator(data + samples), std::make_reverse_iterator(data),
+            [](int16_t s) { return s != 0; });
+        last_sound_end = at(samples - (last - std::make_reverse_iterator(data + samples)));
+        if (sound_posted && !first_sound)
+            first_sound = at(first - data);
+    }
+};
+
+struct Result {
+    std::vector<double> pause_ms, play_ms;
+};
+
+Result run(const std::filesystem::path& dir, bool circular, uint32_t hold_ms) {
+    constexpr uint32_t rate = 48000;
+    constexpr uint8_t channels = 2;
+    auto dev = std::make_shared<SimDevice>(circular, rate, channels);
+    Probe probe;
+    dev->played = [&](const int16_t* data, size_t samples) { probe.played(data, samples, rate, channels); };
+    BenchPlayer player;
+    player.init(dev);
+    player.set_resume_hold(hold_ms);
+    player.search_songs(dir.string());
+    std::atomic<bool> done{};
+    std::thread audio_thread([&] {
+        while (!done)
+            player.task_handler();
+    });
+    player.play();
+    std::this_thread::sleep_for(milliseconds(300));
+
+    Result r;
+    for (int i = 0; i < taps; ++i) {
+        // 暂停后停止DMA的情况下不会再交出数据，所以等足够久后取最后一个非零采样的结束时刻
+        const int64_t paused = now_ns();
+        player.post(Command::TOGGLE);
+        std::this_thread::sleep_for(milliseconds(300));
+        r.pause_ms.push_back((probe.last_sound_end - paused) / 1e6);
+
+        probe.first_sound = 0;
+        probe.sound_posted = now_ns();
+        player.post(Command::TOGGLE);
+        for (int w = 0; w < 1000 && !probe.first_sound; ++w)
+            std::this_thread::sleep_for(milliseconds(1));
+        if (probe.first_sound)
+            r.play_ms.push_back((probe.first_sound - probe.sound_posted) / 1e6);
+        probe.sound_posted = 0;
+        std::this_thread::sleep_for(milliseconds(100));
+    }
+    done = true;
+    player.post(Command::PAUSE); // 唤醒等待命令的播放线程
+    audio_thread.join();
+    dev->transmit_stop();
+    return r;
+}
+
+void print(const char* name, const Result& r) {
+    auto avg = [](const std::vector<double>& v) { return v.empty() ? 0 : std::accumulate(v.begin(), v.end(), 0.0) / v.size(); };
+    auto max = [](const std::vector<double>& v) { return v.empty() ? 0 : *std::max_element(v.begin(), v.end()); };
+    std::printf("%-16s pause->silence avg %5.1f ms max %5.1f ms, play->sound avg %5.1f ms max %5.1f ms (%zu/%d)\n",
+        name, avg(r.pause_ms), max(r.pause_ms), avg(r.play_ms), max(r.play_ms), r.play_ms.size(), taps);
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_tap_latency_bench");
+    std::vector<int16_t> pcm(48000 * 2 * 30);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    if (!write_wav(dir / "song.wav", pcm, 48000, 2))
+        return 1;
+    print("circular, hold", run(dir, true, 10000));
+    print("circular, no hold", run(dir, true, 0));
+    print("linear", run(dir, false, 0));
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,214 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "audio_device.hpp"
+#include "pack_format.hpp"
+
+// 主机测试的公共部分：断言、测试用WAV与包文件、模拟DMA的设备
+
+inline int test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            ++test_failures; \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+// main()的返回值
+inline int test_result() {
+    if (test_failures)
+        std::fprintf(stderr, "%d check(s) failed\n", test_failures);
+    return test_failures ? 1 : 0;
+}
+
+// 每个测试使用自己的临时目录，开始时清空
+inline std::filesystem::path test_dir(const char* name) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+// 测试信号：第i个采样的值，1到32000循环，不含0，便于区分静音与数据
+inline int16_t ramp_sample(size_t i) {
+    return static_cast<int16_t>(i % 32000 + 1);
+}
+
+// 写出16位PCM的WAV文件
+inline bool write_wav(const std::filesystem::path& path, const std::vector<int16_t>& samples, uint32_t rate, uint8_t channels) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    const uint32_t data_size = samples.size() * sizeof(int16_t);
+    auto u32 = [f](uint32_t v) { std::fwrite(&v, 4, 1, f); };
+    auto u16 = [f](uint16_t v) { std::fwrite(&v, 2, 1, f); };
+    std::fwrite("RIFF", 1, 4, f);
+    u32(36 + data_size);
+    std::fwrite("WAVEfmt ", 1, 8, f);
+    u32(16);
+    u16(1);
+    u16(channels);
+    u32(rate);
+    u32(rate * channels * 2);
+    u16(channels * 2);
+    u16(16);
+    std::fwrite("data", 1, 4, f);
+    u32(data_size);
+    const bool ok = std::fwrite(samples.data(), sizeof(int16_t), samples.size(), f) == samples.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+// 按pack_format.hpp写出包文件，每首曲目为同一段PCM
+inline bool write_pack(const std::filesystem::path& path, const std::vector<int16_t>& pcm, uint16_t tracks) {
+    constexpr uint16_t sector = 512;
+    auto align = [](uint64_t v) { return (v + sector - 1) / sector * sector; };
+    const uint64_t size = pcm.size() * sizeof(int16_t);
+    const uint64_t first = align(sizeof(PackHeader) + tracks * sizeof(PackEntry));
+    PackHeader header{};
+    std::memcpy(header.magic, PackHeader::magic_value, sizeof header.magic);
+    header.version = PackHeader::current_version;
+    header.count = tracks;
+    header.entry_size = sizeof(PackEntry);
+    header.sector_size = sector;
+    std::vector<PackEntry> entries(tracks);
+    for (uint16_t k = 0; k < tracks; ++k) {
+        auto& e = entries[k];
+        e.offset = first + k * align(size);
+        e.size = size;
+        e.frames = pcm.size() / 2;
+        e.sample_rate = 48000;
+        e.num_channels = 2;
+        e.bit_depth = 16;
+        e.title_len = std::snprintf(e.title, sizeof e.title, "song%u.wav", unsigned(k));
+    }
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = std::fwrite(&header, sizeof header, 1, f) == 1
+        && std::fwrite(entries.data(), sizeof(PackEntry), tracks, f) == tracks;
+    for (const auto& e : entries) {
+        ok = ok && fseeko(f, off_t(e.offset), SEEK_SET) == 0
+            && std::fwrite(pcm.data(), sizeof(int16_t), pcm.size(), f) == pcm.size();
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+// 模拟I2S与DMA的设备：独立线程按采样率消耗缓冲区，在每个半区（循环模式）或每次传输（非循环模式）结束时
+// 先调用played()交出刚播放完的数据，再触发DMA事件并释放信号量，与中断回调的先后相同
+// 循环模式下played()的数据是各段在播放时刻的内容，不一定等于回调时缓冲区中的内容
+class SimDevice : public AudioDeviceBase {
+    uint32_t rate;
+    uint8_t channels;
+    std::mutex m;
+    std::condition_variable sem_cv, stop_cv;
+    uint32_t sem{};
+    bool stopping{};
+    std::thread dma;
+
+    std::chrono::nanoseconds duration(size_t samples) const {
+        return std::chrono::nanoseconds(uint64_t(samples) * 1000000000 / (uint64_t(rate) * channels));
+    }
+    // 等到deadline，期间调用transmit_stop()时返回false
+    bool wait_until(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock lk(m);
+        return !stop_cv.wait_until(lk, deadline, [this] { return stopping; });
+    }
+    void release() {
+        {
+            std::lock_guard lk(m);
+            ++sem;
+        }
+        sem_cv.notify_all();
+    }
+    void run(int16_t* data, uint16_t size) {
+        auto deadline = std::chrono::steady_clock::now();
+        if (!is_circular_mode()) {
+            if (!wait_until(deadline + duration(size)))
+                return;
+            played(data, size);
+            ++transfers;
+            release();
+            return;
+        }
+        // 与DMA相同，半区内的数据按时间逐段取走：填充迟到时半区开头取走的是旧数据
+        const size_t half = size / 2;
+        std::vector<int16_t> out(half);
+        for (uint8_t index = 0;; index ^= 1) {
+            const auto start = deadline;
+            for (size_t k = 0; k < slices; ++k) {
+                const size_t from = half * k / slices, to = half * (k + 1) / slices;
+                deadline = start + duration(to);
+                if (!wait_until(deadline))
+                    return;
+                std::copy(data + index * half + from, data + index * half + to, out.begin() + from);
+            }
+            played(out.data(), half);
+            if (index)
+                on_dma_complete();
+            else
+                on_dma_half_complete();
+            release();
+        }
+    }
+public:
+    static constexpr size_t slices = 8; // 循环模式下每个半区分几段取走
+    // DMA线程中调用：data为刚播放完的半区或缓冲区
+    std::function<void(const int16_t* data, size_t samples)> played = [](const int16_t*, size_t) {};
+    std::atomic<uint32_t> transfers{}; // 非循环模式下完成的传输次数
+
+    SimDevice(bool circular, uint32_t sample_rate = 48000, uint8_t num_channels = 2)
+        : AudioDeviceBase(circular), rate(sample_rate), channels(num_channels) {
+        set_volume(100); // 音量系数为1，输出与文件中的采样相同
+    }
+    ~SimDevice() {
+        transmit_stop();
+    }
+    void sem_acquire() {
+        std::unique_lock lk(m);
+        sem_cv.wait(lk, [this] { return sem > 0; });
+        --sem;
+    }
+    bool sem_try_acquire() {
+        std::lock_guard lk(m);
+        if (!sem)
+            return false;
+        --sem;
+        return true;
+    }
+    void sem_reset(uint8_t n) {
+        std::lock_guard lk(m);
+        sem = n;
+    }
+    void transmit(int16_t* data, uint16_t size) {
+        transmit_stop(); // 非循环模式下上一次传输已结束，只需回收线程
+        std::lock_guard lk(m);
+        stopping = false;
+        dma = std::thread([this, data, size] { run(data, size); });
+    }
+    void transmit_stop() {
+        {
+            std::lock_guard lk(m);
+            stopping = true;
+        }
+        stop_cv.notify_all();
+        if (dma.joinable() && dma.get_id() != std::this_thread::get_id())
+            dma.join();
+    }
+    void format_set(uint32_t, uint8_t, uint8_t) {}
+};
+
+#endif // TEST_SUPPORT_H
@@ -0,0 +1,72 @@
+// 后台分析：首次扫描为每首曲目写出缓存；缓存全部有效时每次step()只检查一首曲目，每次都经过读卡许可
+// 打包曲库：以PackAudio为音频源分析包内曲目，缓存写在包旁的<包>.info/<序号>中，播放器按同样的路径读取
+#include <cmath>
+#include "pack_audio.hpp"
+#include "track_analyzer.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+template<typename Source>
+uint32_t analyze(const std::vector<std::string>& library, uint32_t& gates) {
+    TrackAnalyzer<Source> analyzer;
+    analyzer.set_io_gate([&gates] { ++gates; return true; });
+    analyzer.set_library(library);
+    uint32_t steps = 0;
+    while (analyzer.step())
+        ++steps;
+    return steps;
+}
+
+} // namespace
+
+int main() {
+    constexpr size_t tracks = 8;
+    const auto dir = test_dir("player_track_analyzer_test");
+    std::vector<std::string> library;
+    std::vector<int16_t> pcm(48000 * 2 / 10);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    for (size_t k = 0; k < tracks; ++k) {
+        library.push_back((dir / ("song" + std::to_string(k) + ".wav")).string());
+        CHECK(write_wav(library.back(), pcm, 48000, 2));
+    }
+
+    uint32_t gates = 0;
+    const uint32_t first = analyze<Audio>(library, gates);
+    for (const auto& track : library) {
+        TrackInfo info;
+        CHECK(info.load(track, pcm.size() * sizeof(int16_t)));
+        CHECK(std::abs(info.peak - pcm.size() / 32768.0f) < 0.01f); // 锯齿波的最大值
+    }
+    CHECK(first > tracks);
+
+    // 全部命中缓存：每首曲目占用一次step()与一次读卡许可
+    gates = 0;
+    const uint32_t cached = analyze<Audio>(library, gates);
+    std::printf("first pass %u steps, cached pass %u steps, %u gate calls for %zu tracks\n", first, cached, gates, tracks);
+    CHECK(cached == tracks);
+    CHECK(gates == tracks);
+
+    // 打包曲库
+    const auto pack_dir = test_dir("player_track_analyzer_pack_test");
+    const auto pack = pack_dir / "music.pak";
+    CHECK(write_pack(pack, pcm, tracks));
+    const auto packed = PackAudio::scan_directory(pack_dir.string());
+    CHECK(packed.size() == tracks);
+    const uint32_t pack_first = analyze<PackAudio>(packed, gates);
+    PackAudio audio;
+    for (size_t k = 0; k < packed.size(); ++k) {
+        CHECK(audio.load(packed[k]) == 0);
+        const auto path = TrackInfo::path_of(audio);
+        CHECK(path.view() == (pack_dir / "music.pak.info" / std::to_string(k)).string());
+        TrackInfo info;
+        CHECK(info.load_from(path, audio.data_size));
+        CHECK(std::abs(info.peak - pcm.size() / 32768.0f) < 0.01f);
+    }
+    const uint32_t pack_cached = analyze<PackAudio>(packed, gates);
+    std::printf("packed: first pass %u steps, cached pass %u steps\n", pack_first, pack_cached);
+    CHECK(pack_first > tracks);
+    CHECK(pack_cached == tracks);
+    return test_result();
+}
@@ -0,0 +1,93 @@
+// 切歌耗时：200首曲目分别存为散装WAV文件与一个打包曲库，按歌单顺序逐首load()并读取第一块16KB
+// 散装文件每次都要打开文件、查找目录并解析WAV头；打包曲库只在第一次打开包并读入索引，之后只在内存中查找并定位一次
+// 分别测量文件在页缓存中（热）与用posix_fadvise丢弃页缓存后（冷）的情况；设备上冷的情况还要加上SD卡的目录查找
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "audio.hpp"
+#include "pack_audio.hpp"
+#include "test_support.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+constexpr uint16_t tracks = 200;
+constexpr unsigned chunk = 16384;
+
+void drop_cache(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+struct SwitchTime {
+    double avg_us, max_us;
+};
+
+// 依次切到每一首，返回每次load()加第一次read()的平均与最大微秒数
+template<typename Source>
+SwitchTime switch_all(const std::vector<std::string>& songs) {
+    Source audio;
+    alignas(4) static uint8_t buf[chunk];
+    double sum = 0, worst = 0;
+    for (const auto& song : songs) {
+        const auto t0 = steady_clock::now();
+        const bool ok = audio.load(song) == 0 && audio.read(buf, chunk) == chunk;
+        const double us = duration<double, std::micro>(steady_clock::now() - t0).count();
+        if (!ok)
+            std::fprintf(stderr, "failed to load %s\n", song.c_str());
+        keep(buf[0]);
+        sum += us;
+        worst = std::max(worst, us);
+    }
+    return {sum / songs.size(), worst};
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_track_switch_bench");
+    const auto loose_dir = dir / "loose", pack_dir = dir / "pack";
+    std::filesystem::create_directories(loose_dir);
+    std::filesystem::create_directories(pack_dir);
+    std::vector<int16_t> pcm(48000 * 2 / 2); // 每首0.5秒
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    for (uint16_t k = 0; k < tracks; ++k) {
+        if (!write_wav(loose_dir / ("song" + std::to_string(k) + ".wav"), pcm, 48000, 2))
+            return 1;
+    }
+    if (!write_pack(pack_dir / "music.pak", pcm, tracks))
+        return 1;
+    const auto loose = Audio::scan_directory(loose_dir.string());
+    const auto packed = PackAudio::scan_directory(pack_dir.string());
+    if (loose.size() != tracks || packed.size() != tracks)
+        return 1;
+
+    for (bool cold : {false, true}) {
+        SwitchTime l{1e300, 0}, p{1e300, 0};
+        for (int r = 0; r < 5; ++r) {
+            if (cold) {
+                for (const auto& song : loose)
+                    drop_cache(song);
+                drop_cache(pack_dir / "music.pak");
+            }
+            const auto lt = switch_all<Audio>(loose);
+            if (cold)
+                drop_cache(pack_dir / "music.pak");
+            const auto pt = switch_all<PackAudio>(packed);
+            if (lt.avg_us < l.avg_us)
+                l = lt;
+            if (pt.avg_us < p.avg_us)
+                p = pt;
+        }
+        std::printf("%s: %u switches, loose files %.1f us avg (max %.0f), pack %.1f us avg (max %.0f)\n",
+            cold ? "cold" : "warm", unsigned(tracks), l.avg_us, l.max_us, p.avg_us, p.max_us);
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
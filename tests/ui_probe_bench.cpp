@@ -0,0 +1,83 @@
+// 界面刷新开销：模拟320x480、RGB565屏幕上LVGL的局部刷新，每帧按失效区域分块渲染到1/10屏的绘制缓冲区再flush
+// 输出几种典型更新（电平表、进度条与时间、频谱、切歌时整屏重绘）下UiProbe统计的每帧渲染耗时与flush字节数，
+// 以及按40MHz SPI估算的总线时间和UiProbe本身每帧的开销；主机上的渲染只是逐像素填色，设备上的绘制更慢
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ui_probe.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+constexpr int32_t width = LV_HOR_RES, height = LV_VER_RES;
+constexpr int32_t buf_lines = height / 10;
+constexpr uint32_t spi_hz = 40000000;
+
+class SimDisplay {
+    lv_display_t* disp;
+    std::vector<uint16_t> draw_buf = std::vector<uint16_t>(width * buf_lines);
+    std::vector<uint16_t> panel = std::vector<uint16_t>(width * height);
+    uint16_t color{};
+
+    // 渲染一块到绘制缓冲区后flush，flush只是拷到屏幕的显存，设备上这里是SPI传输
+    void flush(lv_area_t area) {
+        const int32_t w = lv_area_get_width(&area);
+        for (int32_t y = area.y1; y <= area.y2; ++y)
+            for (int32_t x = 0; x < w; ++x)
+                draw_buf[(y - area.y1) * w + x] = uint16_t(color + x + y);
+        keep(draw_buf.data());
+        lv_display_send_event(disp, LV_EVENT_FLUSH_START, &area);
+        for (int32_t y = area.y1; y <= area.y2; ++y)
+            std::memcpy(&panel[y * width + area.x1], &draw_buf[(y - area.y1) * w], w * sizeof(uint16_t));
+        keep(panel.data());
+    }
+public:
+    explicit SimDisplay(lv_display_t* d) : disp(d) {}
+    void frame(const std::vector<lv_area_t>& areas) {
+        for (auto a : areas)
+            lv_display_send_event(disp, LV_EVENT_INVALIDATE_AREA, &a);
+        lv_display_send_event(disp, LV_EVENT_REFR_START, nullptr);
+        for (const auto& a : areas) {
+            const int32_t w = lv_area_get_width(&a);
+            const int32_t lines = std::min<int32_t>(buf_lines, width * buf_lines / w);
+            for (int32_t y = a.y1; y <= a.y2; y += lines)
+                flush({a.x1, y, a.x2, std::min(a.y2, y + lines - 1)});
+        }
+        lv_display_send_event(disp, LV_EVENT_REFR_READY, nullptr);
+        ++color;
+    }
+};
+
+struct Scenario {
+    const char* name;
+    std::vector<lv_area_t> areas;
+};
+
+} // namespace
+
+int main() {
+    const Scenario scenarios[] = {
+        {"level meter", {{290, 300, 306, 419}, {310, 300, 326, 419}}},
+        {"progress+time", {{20, 380, 299, 385}, {20, 392, 67, 407}, {252, 392, 299, 407}}},
+        {"spectrum", {{10, 180, 309, 279}}},
+        {"full screen", {{0, 0, width - 1, height - 1}}},
+    };
+    UiProbe probe;
+    probe.attach();
+    SimDisplay probed(lv_display_get_default());
+    lv_display_t plain_disp{};
+    SimDisplay plain(&plain_disp);
+    for (const auto& s : scenarios) {
+        constexpr uint32_t frames = 100;
+        const auto t_plain = measure([&] { plain.frame(s.areas); }, frames);
+        probe.reset();
+        const auto t_probed = measure([&] { probed.frame(s.areas); }, frames);
+        const auto r = probe.report();
+        std::printf("%-14s %4u frames, invalidated %6u px, render avg %5u us max %5u us, flush avg %6u B max %6u B"
+            " (SPI %5.2f ms), probe %+.2f us/frame\n",
+            s.name, r.frames, r.invalidated_avg, r.render_avg_us, r.render_max_us, r.flush_bytes_avg, r.flush_bytes_max,
+            r.flush_bytes_avg * 8.0 * 1000 / spi_hz, (t_probed.ns - t_plain.ns) / 1000);
+    }
+    return 0;
+}
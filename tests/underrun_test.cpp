@@ -0,0 +1,112 @@
+// 循环模式欠载：在读取中注入超过一个半区时长的延迟，DMA回绕后重放旧数据
+// 期望播放器检测到欠载、静音正在播放的半区并淡入新数据，延迟结束后不再有旧数据被重放
+// 延迟2.5个半区时在下一次DMA事件按序号差检测；延迟1.5个半区时填充完成后DMA已在播放这个半区，由填充后的检查发现
+#include <map>
+#include "player.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+
+// 第slow_from次读取起，每隔slow_every次读取注入一次慢读取，共slow_count次
+class SlowAudio : public Audio {
+public:
+    static constexpr uint32_t slow_from = 10, slow_every = 6, slow_count = 3;
+    static inline microseconds delay{};
+    static inline std::atomic<uint32_t> reads{}, injected{};
+    static inline std::atomic<bool> slow{};
+    static inline std::atomic<int64_t> slow_end_ns{};
+
+    static void reset(microseconds d) {
+        delay = d;
+        reads = injected = 0;
+        slow = false;
+        slow_end_ns = 0;
+    }
+
+    unsigned read(uint8_t buffer[], unsigned size) override {
+        const uint32_t n = reads++;
+        if (n >= slow_from && (n - slow_from) % slow_every == 0 && injected < slow_count) {
+            slow = true;
+            std::this_thread::sleep_for(delay);
+            ++injected;
+            slow_end_ns = steady_clock::now().time_since_epoch().count();
+            slow = false;
+        }
+        return Audio::read(buffer, size);
+    }
+};
+
+// delay_halves为注入延迟相当于几个半区
+void run_case(double delay_halves) {
+    constexpr uint32_t rate = 48000;
+    constexpr uint8_t channels = 2;
+    const auto dir = test_dir("player_underrun_test");
+    std::vector<int16_t> pcm(rate * channels * 4);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    CHECK(write_wav(dir / "song.wav", pcm, rate, channels));
+
+    auto dev = std::make_shared<SimDevice>(true, rate, channels);
+    BasicPlayer<SimDevice, FunctionLock, SlowAudio> player;
+    player.init(dev);
+    player.search_songs(dir.string());
+
+    // DMA线程中按半区的每一段检查：内容与该段上一次播放的内容完全相同即为重放旧数据
+    // 只允许发生在慢读取期间，或慢读取结束所在的那个半区（播放器要到下一次DMA事件才能发现）
+    // DMA不重启，半区按0、1交替播放
+    constexpr size_t slices = SimDevice::slices;
+    std::vector<int16_t> last[2];
+    int64_t window_start = steady_clock::now().time_since_epoch().count();
+    uint32_t stale = 0, stale_unexpected = 0, silent = 0, halves = 0;
+    dev->played = [&](const int16_t* data, size_t samples) {
+        const int64_t now = steady_clock::now().time_since_epoch().count();
+        auto& prev = last[halves % 2];
+        const bool expected = SlowAudio::slow || SlowAudio::slow_end_ns >= window_start;
+        for (size_t k = 0; k < slices && prev.size() == samples; ++k) {
+            const size_t from = samples * k / slices, to = samples * (k + 1) / slices;
+            if (std::all_of(data + from, data + to, [](int16_t s) { return s == 0; })) {
+                ++silent;
+            } else if (std::equal(data + from, data + to, prev.begin() + from)) {
+                ++stale;
+                if (!expected)
+                    ++stale_unexpected;
+            }
+        }
+        prev.assign(data, data + samples);
+        window_start = now;
+        ++halves;
+    };
+
+    const auto half = duration<double>(8192.0 / (rate * channels));
+    SlowAudio::reset(duration_cast<microseconds>(half * delay_halves));
+
+    std::atomic<bool> done{};
+    std::thread audio_thread([&] {
+        while (!done)
+            player.task_handler();
+    });
+    player.play();
+    std::this_thread::sleep_for(milliseconds(3000));
+    done = true;
+    audio_thread.join();
+    dev->transmit_stop();
+
+    const auto stats = player.get_stats();
+    std::printf("delay %.1f halves: halves %u, stale slices %u, silent slices %u, underruns %u, injected %u\n",
+        delay_halves, halves, stale, silent, stats.underruns, SlowAudio::injected.load());
+    CHECK(SlowAudio::injected == SlowAudio::slow_count);
+    CHECK(stats.underruns >= SlowAudio::slow_count); // 每次慢读取都被检测到
+    CHECK(stale > 0);                                // 确实播放了旧数据
+    CHECK(stale_unexpected == 0);                    // 延迟结束后不再重放旧数据
+    CHECK(silent >= SlowAudio::slow_count);          // 检测到欠载后静音正在播放的半区
+}
+
+} // namespace
+
+int main() {
+    run_case(2.5); // 每次慢读取超过两个半区，DMA必定回绕
+    run_case(1.5); // 迟到不足两个半区
+    return test_result();
+}
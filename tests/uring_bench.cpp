@@ -0,0 +1,101 @@
+// UringAudio与stdio的Audio在磁盘繁忙时的读取延迟：另一线程不断写大文件并fdatasync、丢弃歌曲的页缓存，
+// 播放线程按固定节奏每次读取16KB，统计每次read()的p50/p99/最大耗时与UringAudio的重试次数
+// 分别测量空闲与繁忙两种情况；结果取决于所在的文件系统与磁盘，tmpfs上两者都只是内存拷贝
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include "audio.hpp"
+#include "uring_audio.hpp"
+#include "test_support.hpp"
+#include "bench_support.hpp"
+
+namespace {
+
+using namespace std::chrono;
+constexpr unsigned chunk = 16384;
+constexpr int reads = 1500;
+
+void drop_cache(const std::filesystem::path& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// 写入与同步造成的磁盘压力，直到stop
+void load_disk(const std::filesystem::path& dir, const std::filesystem::path& song, const std::atomic<bool>& stop) {
+    const auto path = dir / "load.bin";
+    std::vector<char> block(1 << 20, 'x');
+    while (!stop) {
+        const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return;
+        for (int i = 0; i < 16 && !stop; ++i) {
+            keep(write(fd, block.data(), block.size()));
+            if (i % 4 == 3)
+                fdatasync(fd);
+        }
+        close(fd);
+        drop_cache(song);
+    }
+    std::filesystem::remove(path);
+}
+
+struct Latency {
+    double p50, p99, max;
+};
+
+template<typename Source>
+Latency read_latency(Source& audio, const std::filesystem::path& path) {
+    drop_cache(path);
+    audio.load(path.string());
+    alignas(4) static uint8_t buf[chunk];
+    std::vector<double> us;
+    us.reserve(reads);
+    for (int i = 0; i < reads; ++i) {
+        const auto t0 = steady_clock::now();
+        if (audio.read(buf, chunk) != chunk)
+            audio.seek_frame(0);
+        us.push_back(duration<double, std::micro>(steady_clock::now() - t0).count());
+        keep(buf[0]);
+        std::this_thread::sleep_for(microseconds(1000)); // 播放线程在两次读取之间处理与等待DMA
+    }
+    std::sort(us.begin(), us.end());
+    return {us[us.size() / 2], us[us.size() * 99 / 100], us.back()};
+}
+
+} // namespace
+
+int main() {
+    const auto dir = test_dir("player_uring_bench");
+    const auto path = dir / "song.wav";
+    std::vector<int16_t> pcm(48000 * 2 * 300); // 5分钟，约55MB
+    for (size_t i = 0; i < pcm.size(); ++i)
+        pcm[i] = ramp_sample(i);
+    if (!write_wav(path, pcm, 48000, 2))
+        return 1;
+
+    for (bool busy : {false, true}) {
+        std::atomic<bool> stop{};
+        std::thread load;
+        if (busy)
+            load = std::thread(load_disk, dir, path, std::cref(stop));
+        Audio stdio_audio;
+        const auto s = read_latency(stdio_audio, path);
+        UringAudio uring_audio;
+        const auto u = read_latency(uring_audio, path);
+        stop = true;
+        if (load.joinable())
+            load.join();
+        const auto st = uring_audio.get_stats();
+        std::printf("%-4s stdio p50 %6.1f us p99 %8.1f us max %8.1f us; uring%s p50 %6.1f us p99 %8.1f us max %8.1f us, %u retries\n",
+            busy ? "busy" : "idle", s.p50, s.p99, s.max, st.uring ? "" : "(threads)", u.p50, u.p99, u.max, st.retries);
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
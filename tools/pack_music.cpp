@@ -0,0 +1,174 @@
+// 打包曲库生成工具，在主机上运行，把目录中的.wav文件打包为PackAudio可播放的.pak文件
+// 编译：g++ -std=c++20 -O2 -I.. pack_music.cpp -o pack_music
+// 用法：pack_music [-s 单个包的最大字节数] [-a 对齐字节数] <输出.pak> <曲目目录>
+// 曲目按文件名排序，超出单个包的上限时拆分为"名称-1.pak"、"名称-2.pak"...，
+// 默认上限为2GB，使32位平台上的fseek可以访问整个包
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "audio.hpp"
+#include "pack_format.hpp"
+
+namespace {
+
+struct Track {
+    std::string path;
+    std::string title;
+    PackEntry entry{};
+};
+
+uint64_t align_up(uint64_t v, uint64_t align) {
+    return (v + align - 1) / align * align;
+}
+
+uint64_t index_size(size_t count, uint16_t sector) {
+    return align_up(sizeof(PackHeader) + count * sizeof(PackEntry), sector);
+}
+
+bool write_zeros(FILE* out, uint64_t n) {
+    static const uint8_t zeros[4096]{};
+    while (n) {
+        const size_t chunk = std::min<uint64_t>(n, sizeof zeros);
+        if (fwrite(zeros, 1, chunk, out) != chunk)
+            return false;
+        n -= chunk;
+    }
+    return true;
+}
+
+// 写出一个包，tracks中的offset在此填写
+bool write_pack(const std::string& name, std::vector<Track>& tracks, uint16_t sector) {
+    FILE* out = fopen(name.c_str(), "wb");
+    if (!out) {
+        fprintf(stderr, "无法创建%s\n", name.c_str());
+        return false;
+    }
+    uint64_t offset = index_size(tracks.size(), sector);
+    for (auto& t : tracks) {
+        t.entry.offset = offset;
+        offset = align_up(offset + t.entry.size, sector);
+    }
+
+    PackHeader header{};
+    std::memcpy(header.magic, PackHeader::magic_value, sizeof header.magic);
+    header.version = PackHeader::current_version;
+    header.count = static_cast<uint16_t>(tracks.size());
+    header.entry_size = sizeof(PackEntry);
+    header.sector_size = sector;
+    bool ok = fwrite(&header, sizeof header, 1, out) == 1;
+    for (const auto& t : tracks)
+        ok = ok && fwrite(&t.entry, sizeof t.entry, 1, out) == 1;
+
+    std::vector<uint8_t> buffer(1 << 16);
+    uint64_t pos = sizeof(PackHeader) + tracks.size() * sizeof(PackEntry);
+    for (const auto& t : tracks) {
+        if (!ok)
+            break;
+        ok = write_zeros(out, t.entry.offset - pos);
+        Audio audio;
+        if (audio.load(t.path) == -1) {
+            fprintf(stderr, "无法读取%s\n", t.path.c_str());
+            ok = false;
+            break;
+        }
+        uint64_t left = t.entry.size;
+        while (ok && left) {
+            const unsigned n = audio.read(buffer.data(), std::min<uint64_t>(left, buffer.size()));
+            ok = n > 0 && fwrite(buffer.data(), 1, n, out) == n;
+            left -= n;
+        }
+        pos = t.entry.offset + t.entry.size;
+    }
+    ok = ok && write_zeros(out, align_up(pos, sector) - pos);
+    ok = fclose(out) == 0 && ok;
+    if (!ok)
+        fprintf(stderr, "写入%s失败\n", name.c_str());
+    else
+        printf("%s: %zu首，%llu字节\n", name.c_str(), tracks.size(), static_cast<unsigned long long>(align_up(pos, sector)));
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t max_size = (1ull << 31) - 1;
+    uint16_t sector = 512;
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        if (std::strcmp(argv[i], "-s") == 0)
+            max_size = std::strtoull(argv[i + 1], nullptr, 0);
+        else if (std::strcmp(argv[i], "-a") == 0)
+            sector = static_cast<uint16_t>(std::strtoul(argv[i + 1], nullptr, 0));
+        else
+            break;
+    }
+    if (argc - i != 2 || sector == 0 || (sector & (sector - 1)) != 0) {
+        fprintf(stderr, "用法：%s [-s 单个包的最大字节数] [-a 对齐字节数(2的幂)] <输出.pak> <曲目目录>\n", argv[0]);
+        return 2;
+    }
+    std::string output = argv[i];
+    if (!std::string_view(output).ends_with(".pak"))
+        output += ".pak";
+
+    auto files = Audio::scan_directory(argv[i + 1]);
+    std::sort(files.begin(), files.end());
+
+    std::vector<Track> tracks;
+    for (const auto& path : files) {
+        Audio audio;
+        if (audio.load(path) == -1 || audio.block_align() == 0) {
+            fprintf(stderr, "跳过无法解析的%s\n", path.c_str());
+            continue;
+        }
+        Track t;
+        t.path = path;
+        t.title = path.substr(path.find_last_of('/') + 1);
+        if (t.title.size() > PackEntry::title_capacity) {
+            fprintf(stderr, "跳过文件名超过%zu字节的%s\n", PackEntry::title_capacity, path.c_str());
+            continue;
+        }
+        t.entry.size = audio.data_size / audio.block_align() * audio.block_align();
+        t.entry.frames = audio.total_frames();
+        t.entry.sample_rate = audio.sample_rate;
+        t.entry.num_channels = audio.num_channels;
+        t.entry.bit_depth = audio.bit_depth;
+        t.entry.title_len = static_cast<uint8_t>(t.title.size());
+        std::memcpy(t.entry.title, t.title.data(), t.title.size());
+        tracks.push_back(std::move(t));
+    }
+    if (tracks.empty()) {
+        fprintf(stderr, "%s中没有可打包的.wav文件\n", argv[i + 1]);
+        return 1;
+    }
+
+    // 按顺序分组，每组的总长度不超过max_size
+    std::vector<std::vector<Track>> packs(1);
+    uint64_t used = 0;
+    for (auto& t : tracks) {
+        auto& cur = packs.back();
+        const uint64_t need = align_up(t.entry.size, sector);
+        const uint64_t total = index_size(cur.size() + 1, sector) + used + need;
+        if (!cur.empty() && (total > max_size || cur.size() == PackHeader::max_count)) {
+            packs.emplace_back();
+            used = 0;
+        }
+        if (index_size(1, sector) + need > max_size) {
+            fprintf(stderr, "%s超过单个包的上限\n", t.path.c_str());
+            return 1;
+        }
+        packs.back().push_back(std::move(t));
+        used += need;
+    }
+
+    const std::string stem = output.substr(0, output.size() - 4);
+    for (size_t k = 0; k < packs.size(); ++k) {
+        const std::string name = packs.size() == 1 ? output : stem + '-' + std::to_string(k + 1) + ".pak";
+        if (!write_pack(name, packs[k], sector))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+// 时间线追踪：把带时间戳的事件写入RAM中的环形缓冲区，满后覆盖最旧的事件
+// 缓冲区由调用者在start()时提供，未启动时每个事件只有一次原子读取的开销
+// 导出为Chrome trace JSON（chrome://tracing或ui.perfetto.dev可直接打开），用于查看各环节的先后与抖动
+// 每个线程占一行，首次记录时自动分配；中断中的事件使用irq_*()，固定在第0行
+class Trace {
+public:
+    struct Event {
+        const char* name; // 必须是字符串常量
+        uint32_t ts;      // 微秒
+        int32_t value;    // 计数器的值
+        char phase;       // 'B'开始 'E'结束 'i'瞬时 'C'计数器
+        uint8_t track;
+    };
+    static constexpr uint8_t max_tracks = 8;
+private:
+    static inline std::atomic<bool> enabled{};
+    static inline std::span<Event> events{};
+    static inline std::atomic<uint32_t> head{};
+    static inline std::atomic<uint8_t> next_track{1};
+    static inline std::array<const char*, max_tracks> track_names{"irq"};
+    static inline thread_local uint8_t current_track{};
+    static inline uint32_t (*clock)() = [] {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    };
+
+    static uint8_t track() {
+        if (!current_track) {
+            const uint8_t t = next_track.fetch_add(1, std::memory_order_relaxed);
+            current_track = t < max_tracks ? t : max_tracks - 1; // 线程过多时共用最后一行
+        }
+        return current_track;
+    }
+    static void record(const char* name, char phase, uint8_t tr, int32_t value = 0) {
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+        const uint32_t i = head.fetch_add(1, std::memory_order_relaxed);
+        events[i % events.size()] = {name, clock(), value, phase, tr};
+    }
+public:
+    // 开始记录，storage在stop()之前必须保持有效
+    static void start(std::span<Event> storage) {
+        enabled.store(false, std::memory_order_relaxed);
+        events = storage;
+        head.store(0, std::memory_order_relaxed);
+        enabled.store(!storage.empty(), std::memory_order_release);
+    }
+    static void stop() {
+        enabled.store(false, std::memory_order_release);
+    }
+    // 时间源，返回微秒，例如MCU上由DWT周期计数器换算
+    static void set_clock(uint32_t (*us)()) {
+        clock = us;
+    }
+    // 给当前线程所在的行命名，在导出时显示
+    static void name_thread(const char* name) {
+        track_names[track()] = name;
+    }
+
+    static void begin(const char* name) { record(name, 'B', track()); }
+    static void end(const char* name) { record(name, 'E', track()); }
+    static void instant(const char* name) { record(name, 'i', track()); }
+    static void counter(const char* name, int32_t value) { record(name, 'C', track(), value); }
+    static void irq_instant(const char* name) { record(name, 'i', 0); }
+
+    // 作用域内的区间
+    class Scope {
+        const char* name;
+    public:
+        explicit Scope(const char* name) : name(name) { begin(name); }
+        ~Scope() { end(name); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // 已记录的事件数，超过缓冲区容量时只保留最近的部分
+    static uint32_t size() {
+        return std::min<uint32_t>(head.load(std::memory_order_acquire), events.size());
+    }
+    // 导出为Chrome trace JSON，应在stop()之后调用，返回写出的事件数
+    static uint32_t export_json(FILE* out) {
+        const uint32_t end = head.load(std::memory_order_acquire);
+        const uint32_t n = size();
+        fputs("{\"traceEvents\":[\n", out);
+        bool first = true;
+        for (uint8_t t = 0; t < max_tracks; ++t) {
+            if (!track_names[t])
+                continue;
+            fprintf(out, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", t, track_names[t]);
+            first = false;
+        }
+        for (uint32_t i = end - n; i != end; ++i) {
+            const Event& e = events[i % events.size()];
+            fprintf(out, "%s{\"ph\":\"%c\",\"name\":\"%s\",\"pid\":0,\"tid\":%u,\"ts\":%lu",
+                first ? "" : ",\n", e.phase, e.name, e.track, static_cast<unsigned long>(e.ts));
+            if (e.phase == 'C')
+                fprintf(out, ",\"args\":{\"value\":%ld}", static_cast<long>(e.value));
+            else if (e.phase == 'i')
+                fputs(",\"s\":\"t\"", out);
+            fputc('}', out);
+            first = false;
+        }
+        fputs("\n]}\n", out);
+        return n;
+    }
+};
+
+#endif // TRACE_H
@@ -0,0 +1,96 @@
+#ifndef TRACK_ANALYZER_H
+#define TRACK_ANALYZER_H
+
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include "audio.hpp"
+#include "loudness.hpp"
+#include "track_info.hpp"
+
+// 后台分析曲库：逐首计算响度和波形概览并写入缓存，每首曲目只读取一遍，每次step()只处理一小块数据
+// 应在低优先级线程中循环调用，所有成员函数都须在该线程中调用
+// Source与播放器的音频源相同，曲库为其scan_directory()列出的歌曲名（如PackAudio的包内曲目）
+template<AudioSourceType Source = Audio>
+class TrackAnalyzer {
+    std::vector<std::string> library;
+    size_t next_track{};
+    Source audio;
+    LoudnessMeter meter;
+    TrackInfo info;
+    uint64_t total_frames{}, frame_pos{};
+    bool analyzing{};
+    std::function<bool()> io_gate = [] { return true; };
+    int16_t chunk[1024];
+
+    // 打开下一首曲目，无法打开或已有有效缓存时返回false；每次只检查一首，曲库大多已缓存时也不会连续读卡
+    bool open_next() {
+        const auto& track = library[next_track++];
+        if (audio.load(track) == -1 || audio.num_channels == 0)
+            return false;
+        if (info.load_from(TrackInfo::path_of(audio), audio.data_size))
+            return false;
+        meter.reset(audio.sample_rate, audio.num_channels);
+        info = {};
+        info.overview_min.fill(INT8_MAX);
+        info.overview_max.fill(INT8_MIN);
+        total_frames = std::max<uint64_t>(audio.data_size / 2 / audio.num_channels, 1);
+        frame_pos = 0;
+        return true;
+    }
+    void overview_update(const int16_t* samples, size_t frames) {
+        const uint8_t channels = audio.num_channels;
+        for (size_t i = 0; i < frames; ++i, ++frame_pos) {
+            const size_t bin = std::min<size_t>(frame_pos * TrackInfo::overview_bins / total_frames, TrackInfo::overview_bins - 1);
+            for (uint8_t c = 0; c < channels; ++c) {
+                const auto v = static_cast<int8_t>(samples[i * channels + c] >> 8);
+                info.overview_min[bin] = std::min(info.overview_min[bin], v);
+                info.overview_max[bin] = std::max(info.overview_max[bin], v);
+            }
+        }
+    }
+    void finish() {
+        for (size_t i = 0; i < TrackInfo::overview_bins; ++i) {
+            if (info.overview_min[i] > info.overview_max[i])
+                info.overview_min[i] = info.overview_max[i] = 0;
+        }
+        info.data_size = static_cast<uint32_t>(audio.data_size);
+        info.loudness = meter.integrated();
+        info.peak = meter.sample_peak();
+        info.save_to(TrackInfo::path_of(audio));
+        analyzing = false;
+    }
+public:
+    // 读卡许可：返回false时本次step()不读取，用于避开播放线程的读取，参见Player::io_window()
+    void set_io_gate(std::function<bool()> gate) {
+        io_gate = std::move(gate);
+    }
+    void set_library(std::vector<std::string> tracks) {
+        library = std::move(tracks);
+        next_track = 0;
+        analyzing = false;
+    }
+    // 处理一块数据或检查一首曲目的缓存，全部完成后返回false
+    // 打开曲目与读取缓存同样占用一次读卡许可，之后的step()才开始读取数据
+    bool step() {
+        if (!analyzing && next_track >= library.size())
+            return false;
+        if (!io_gate())
+            return true;
+        if (!analyzing) {
+            analyzing = open_next();
+            return true;
+        }
+        const unsigned bytes = audio.read(reinterpret_cast<uint8_t*>(chunk), sizeof chunk);
+        const size_t frames = bytes / 2 / audio.num_channels;
+        meter.process(chunk, frames);
+        overview_update(chunk, frames);
+        if (bytes < sizeof chunk)
+            finish();
+        return true;
+    }
+};
+
+#endif // TRACK_ANALYZER_H
@@ -0,0 +1,107 @@
+#ifndef TRACK_INFO_H
+#define TRACK_INFO_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <sys/stat.h>
+#include "alloc_guard.hpp"
+#include "fixed_string.hpp"
+
+// 曲目分析结果，与曲目保存在同一目录下（<曲目路径>.info）
+// 打包曲库中的曲目不能写入包文件，缓存放在包旁的目录中（<包路径>.info/<包内序号>）
+struct TrackInfo {
+    static constexpr uint32_t magic = 0x324B5254; // "TRK2"
+    static constexpr float reference_lufs = -18.0f; // ReplayGain 2.0 参考响度
+    static constexpr float max_gain_db = 12.0f;
+    static constexpr size_t overview_bins = 128;
+
+    uint32_t tag{magic};
+    uint32_t data_size{}; // 分析时数据长度的低32位，用于判断缓存是否过期
+    float loudness{};     // 积分响度 LUFS
+    float peak{};         // 采样峰值，满幅为1
+    // 波形概览：整首曲目均分为overview_bins段，每段的最小/最大采样（高8位）
+    std::array<int8_t, overview_bins> overview_min{};
+    std::array<int8_t, overview_bins> overview_max{};
+
+    // 归一化增益，不超过峰值允许的范围以免削波
+    float gain_db() const {
+        float gain = reference_lufs - loudness;
+        if (peak > 0)
+            gain = std::min(gain, -20.0f * std::log10(peak));
+        return std::clamp(gain, -max_gain_db, max_gain_db);
+    }
+
+    // 定长路径，切歌时读取缓存不申请堆内存；路径过长时返回空串，fopen失败即视为没有缓存
+    using Path = FixedString<PathString::capacity() + 12>;
+
+    static Path path_of(std::string_view track) {
+        Path path;
+        if (!path.assign(track) || !path.append(".info"))
+            path.clear();
+        return path;
+    }
+    // 包内第index首曲目
+    static Path path_of(std::string_view archive, uint16_t index) {
+        char num[8];
+        const int n = std::snprintf(num, sizeof num, "/%u", unsigned(index));
+        Path path;
+        if (!path.assign(archive) || !path.append(".info") || !path.append({num, size_t(n)}))
+            path.clear();
+        return path;
+    }
+    // 音频源当前加载的曲目，提供archive()/entry_index()的音频源（PackAudio）按包内序号定位
+    template<typename A>
+    static Path path_of(const A& audio) {
+        if constexpr (requires { audio.archive(); audio.entry_index(); })
+            return path_of(audio.archive(), audio.entry_index());
+        else
+            return path_of(audio.name.view());
+    }
+
+    // 读取缓存，不存在或已过期时返回false
+    // 缓存中只存数据长度的低32位，超过4GB的RF64文件也足以判断是否过期
+    // 切歌时在播放线程调用：打开文件的分配不计入AllocGuard，只读一次，不使用stdio缓冲区（否则第一次fread时申请）
+    bool load_from(const Path& path, uint64_t expected_size) {
+        FILE* file;
+        {
+            AllocGuard::Allow allow;
+            file = fopen(path.c_str(), "rb");
+        }
+        if (!file)
+            return false;
+        setvbuf(file, nullptr, _IONBF, 0);
+        TrackInfo info;
+        const bool ok = fread(&info, sizeof info, 1, file) == 1 && info.tag == magic && info.data_size == static_cast<uint32_t>(expected_size);
+        fclose(file);
+        if (ok)
+            *this = info;
+        return ok;
+    }
+    // 所在目录不存在时（包的缓存目录）先创建
+    bool save_to(const Path& path) const {
+        FILE* file = fopen(path.c_str(), "wb");
+        const size_t slash = path.view().rfind('/');
+        if (!file && slash != std::string_view::npos && slash > 0) {
+            PathString dir;
+            if (dir.assign(path.view().substr(0, slash)) && mkdir(dir.c_str(), 0777) == 0)
+                file = fopen(path.c_str(), "wb");
+        }
+        if (!file)
+            return false;
+        const bool ok = fwrite(this, sizeof *this, 1, file) == 1;
+        fclose(file);
+        return ok;
+    }
+    bool load(std::string_view track, uint64_t expected_size) {
+        return load_from(path_of(track), expected_size);
+    }
+    bool save(std::string_view track) const {
+        return save_to(path_of(track));
+    }
+};
+
+#endif // TRACK_INFO_H
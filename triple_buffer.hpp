@@ -0,0 +1,36 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// 三缓冲：单写者发布完整的数据块，单读者随时取得最新一份，双方均不阻塞
+template<typename T>
+class TripleBuffer {
+    static constexpr uint8_t dirty = 0x4;
+    std::array<T, 3> slots{};
+    std::atomic<uint8_t> middle{1}; // 低两位为中间槽位，dirty表示有未读取的新数据
+    uint8_t back{0};  // 写者独占
+    uint8_t front{2}; // 读者独占
+public:
+    // 写者：填充write_buffer()后调用publish()
+    T& write_buffer() {
+        return slots[back];
+    }
+    void publish() {
+        back = middle.exchange(back | dirty, std::memory_order_acq_rel) & 3;
+    }
+    // 读者：有新数据时切换到最新一份，返回是否切换
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & dirty))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+    const T& read_buffer() const {
+        return slots[front];
+    }
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -0,0 +1,123 @@
+#ifndef UI_PROBE_H
+#define UI_PROBE_H
+
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <lvgl.h>
+#include "trace.hpp"
+
+// 界面开销测量：LVGL堆占用、控件数量、每帧申请重绘的面积、渲染耗时和发送到屏幕的字节数
+// 只用于调试对比，在LVGL线程中attach()后运行一段时间再调用report()
+// 同时把刷新区间与每次flush的字节数写入Trace
+class UiProbe {
+public:
+    struct Report {
+        uint32_t objects;           // 屏幕上的控件总数（含屏幕本身）
+        uint32_t heap_used;         // LVGL堆已用字节数
+        uint32_t heap_max_used;     // LVGL堆峰值
+        uint8_t heap_frag_pct;
+        uint32_t frames;            // 有重绘的帧数
+        uint32_t invalidated_avg;   // 每帧申请重绘的像素数，重叠区域重复计算
+        uint32_t invalidated_max;
+        uint32_t render_avg_us;     // 每帧从开始刷新到刷新完成的耗时，包含等待flush
+        uint32_t render_max_us;
+        uint32_t flush_bytes_avg;   // 每帧交给flush回调的字节数，SPI屏幕上即总线流量
+        uint32_t flush_bytes_max;
+    };
+private:
+    using Clock = std::chrono::steady_clock;
+
+    lv_display_t* display{};
+    uint32_t pending{};
+    uint32_t frames{};
+    uint64_t total{};
+    uint32_t peak{};
+    // 当前这一帧
+    Clock::time_point refr_start{};
+    uint32_t flushed{};
+    // 有flush的帧
+    uint32_t rendered{};
+    uint64_t render_total{}, flush_total{};
+    uint32_t render_peak{}, flush_peak{};
+
+    static uint32_t count(lv_obj_t* obj) {
+        uint32_t n = 1;
+        for (uint32_t i = 0; i < lv_obj_get_child_count(obj); ++i)
+            n += count(lv_obj_get_child(obj, i));
+        return n;
+    }
+    static UiProbe* self_of(lv_event_t* e) {
+        return static_cast<UiProbe*>(lv_event_get_user_data(e));
+    }
+public:
+    void attach(lv_display_t* disp = lv_display_get_default()) {
+        display = disp;
+        lv_display_add_event_cb(disp, [](lv_event_t* e) {
+            auto area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+            if (area)
+                self_of(e)->pending += lv_area_get_width(area) * lv_area_get_height(area);
+        }, LV_EVENT_INVALIDATE_AREA, this);
+        // 每次刷新开始时结算上一批失效区域
+        lv_display_add_event_cb(disp, [](lv_event_t* e) {
+            auto self = self_of(e);
+            Trace::begin("refresh");
+            self->refr_start = Clock::now();
+            self->flushed = 0;
+            if (!self->pending)
+                return;
+            ++self->frames;
+            self->total += self->pending;
+            self->peak = std::max(self->peak, self->pending);
+            self->pending = 0;
+        }, LV_EVENT_REFR_START, this);
+        lv_display_add_event_cb(disp, [](lv_event_t* e) {
+            auto self = self_of(e);
+            auto area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+            if (!area)
+                return;
+            const uint32_t bytes = lv_area_get_width(area) * lv_area_get_height(area)
+                * lv_color_format_get_size(lv_display_get_color_format(self->display));
+            self->flushed += bytes;
+            Trace::counter("flush_bytes", bytes);
+        }, LV_EVENT_FLUSH_START, this);
+        lv_display_add_event_cb(disp, [](lv_event_t* e) {
+            auto self = self_of(e);
+            Trace::end("refresh");
+            if (!self->flushed)
+                return;
+            auto us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - self->refr_start).count());
+            ++self->rendered;
+            self->render_total += us;
+            self->render_peak = std::max(self->render_peak, us);
+            self->flush_total += self->flushed;
+            self->flush_peak = std::max(self->flush_peak, self->flushed);
+        }, LV_EVENT_REFR_READY, this);
+    }
+    void reset() {
+        pending = frames = peak = 0;
+        total = 0;
+        rendered = render_peak = flush_peak = 0;
+        render_total = flush_total = 0;
+    }
+    Report report(lv_obj_t* screen = lv_screen_active()) const {
+        lv_mem_monitor_t mon;
+        lv_mem_monitor(&mon);
+        return {
+            .objects = count(screen),
+            .heap_used = uint32_t(mon.total_size - mon.free_size),
+            .heap_max_used = uint32_t(mon.max_used),
+            .heap_frag_pct = mon.frag_pct,
+            .frames = frames,
+            .invalidated_avg = frames ? uint32_t(total / frames) : 0,
+            .invalidated_max = peak,
+            .render_avg_us = rendered ? uint32_t(render_total / rendered) : 0,
+            .render_max_us = render_peak,
+            .flush_bytes_avg = rendered ? uint32_t(flush_total / rendered) : 0,
+            .flush_bytes_max = flush_peak,
+        };
+    }
+};
+
+#endif
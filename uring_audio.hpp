@@ -0,0 +1,469 @@
+#ifndef URING_AUDIO_H
+#define URING_AUDIO_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "audio.hpp"
+
+// Linux下的异步读取后端：始终保持queue_depth个读取请求在途，播放线程取数据时通常已经读好，
+// 慢速的USB/SD介质上可以吸收单次读取的延迟抖动
+// 优先使用io_uring（直接系统调用，不依赖liburing），内核不支持或被禁用时退回线程池+pread
+// 数据尽量以O_DIRECT读取，缓冲区、偏移和长度都按4KB对齐
+class UringAudio : public AudioBase {
+public:
+    struct Config {
+        uint8_t queue_depth = 4;        // 在途读取数
+        uint32_t read_size = 64 * 1024; // 单次读取长度，向上对齐到4KB
+        bool direct = true;             // 尝试O_DIRECT，文件系统不支持时自动退回普通读取
+        uint8_t retries = 3;            // 一段读取出错或短读时从断处重新提交的次数，用完后才当作文件结束
+    };
+    struct Stats {
+        bool uring;             // 是否在使用io_uring
+        bool direct;            // 是否在使用O_DIRECT
+        uint32_t reads;         // 已完成的读取数
+        uint32_t waits;         // read()时数据尚未读好、需要等待的次数
+        uint32_t retries;       // 出错或短读后重新提交的次数
+        uint32_t wait_p50_us;   // 等待时长分位数，按2的幂分桶，取桶的上界
+        uint32_t wait_p99_us;
+        uint32_t wait_max_us;
+    };
+private:
+    static constexpr size_t align = 4096;
+    static constexpr ssize_t pending = std::numeric_limits<ssize_t>::min();
+
+    // 读取引擎：submit提交一次读取，wait阻塞到该槽位完成并返回读取的字节数（负数为-errno）
+    class Engine {
+    public:
+        virtual bool submit(uint8_t slot, int fd, void* buf, size_t len, off_t off) = 0;
+        virtual bool ready(uint8_t slot) = 0;
+        virtual ssize_t wait(uint8_t slot) = 0;
+        virtual ~Engine() = default;
+    };
+
+    class UringEngine : public Engine {
+        int ring{-1};
+        void* sq_ptr{MAP_FAILED};
+        void* cq_ptr{MAP_FAILED};
+        void* sqe_ptr{MAP_FAILED};
+        size_t sq_len{}, cq_len{}, sqe_len{};
+        unsigned *sq_head{}, *sq_tail{}, *sq_mask{}, *sq_array{};
+        unsigned *cq_head{}, *cq_tail{}, *cq_mask{};
+        io_uring_sqe* sqes{};
+        io_uring_cqe* cqes{};
+        std::vector<iovec> iov;
+        std::vector<ssize_t> results;
+
+        static int enter(int fd, unsigned submit, unsigned min_complete, unsigned flags) {
+            return syscall(__NR_io_uring_enter, fd, submit, min_complete, flags, nullptr, 0);
+        }
+        // 取出所有已完成的请求，block时至少等到一个
+        void reap(bool block) {
+            if (block)
+                enter(ring, 0, 1, IORING_ENTER_GETEVENTS);
+            unsigned head = *cq_head;
+            const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const auto& cqe = cqes[head & *cq_mask];
+                results[cqe.user_data] = cqe.res;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+    public:
+        bool init(unsigned entries) {
+            io_uring_params p{};
+            ring = syscall(__NR_io_uring_setup, entries, &p);
+            if (ring < 0)
+                return false;
+            sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+            if (single)
+                sq_len = cq_len = std::max(sq_len, cq_len);
+            sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+            if (sq_ptr == MAP_FAILED)
+                return false;
+            cq_ptr = single ? sq_ptr
+                : mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED)
+                return false;
+            sqe_len = p.sq_entries * sizeof(io_uring_sqe);
+            sqe_ptr = mmap(nullptr, sqe_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+            if (sqe_ptr == MAP_FAILED)
+                return false;
+
+            auto sq = static_cast<uint8_t*>(sq_ptr), cq = static_cast<uint8_t*>(cq_ptr);
+            sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+            sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+            sq_mask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+            cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+            cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+            sqes = static_cast<io_uring_sqe*>(sqe_ptr);
+            iov.resize(entries);
+            results.assign(entries, 0);
+            return true;
+        }
+        // 在途请求数不超过队列深度，提交队列不会满；每次提交立即进入内核
+        // 内核要在io_uring_enter中读取尾指针，所以先发布再进入；进入失败且SQE未被取走时收回尾指针，
+        // 否则这个SQE会在下一次提交时被一并带走，完成结果与槽位错位
+        bool submit(uint8_t slot, int fd, void* buf, size_t len, off_t off) override {
+            const unsigned tail = *sq_tail;
+            const unsigned index = tail & *sq_mask;
+            auto& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof sqe);
+            iov[slot] = {buf, len};
+            sqe.opcode = IORING_OP_READV; // 5.1起支持，比IORING_OP_READ兼容更早的内核
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<uint64_t>(&iov[slot]);
+            sqe.len = 1;
+            sqe.off = off;
+            sqe.user_data = slot;
+            sq_array[index] = index;
+            results[slot] = pending;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+            int ret;
+            do {
+                ret = enter(ring, 1, 0, 0);
+            } while (ret < 0 && errno == EINTR);
+            if (ret == 1 || __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == tail + 1)
+                return true; // 已被内核取走，结果会出现在完成队列中
+            __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+            results[slot] = ret < 0 ? -errno : -EAGAIN;
+            return false;
+        }
+        bool ready(uint8_t slot) override {
+            reap(false);
+            return results[slot] != pending;
+        }
+        ssize_t wait(uint8_t slot) override {
+            reap(false);
+            while (results[slot] == pending)
+                reap(true);
+            return results[slot];
+        }
+        ~UringEngine() {
+            if (sqe_ptr != MAP_FAILED)
+                munmap(sqe_ptr, sqe_len);
+            if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+                munmap(cq_ptr, cq_len);
+            if (sq_ptr != MAP_FAILED)
+                munmap(sq_ptr, sq_len);
+            if (ring >= 0)
+                ::close(ring);
+        }
+    };
+
+    class ThreadEngine : public Engine {
+        struct Request {
+            uint8_t slot;
+            int fd;
+            void* buf;
+            size_t len;
+            off_t off;
+        };
+        std::mutex mutex;
+        std::condition_variable cv, done_cv;
+        // 定长环形队列：每个槽位最多一个请求在途，容量为槽位数即不会溢出，提交时不申请内存
+        std::vector<Request> queue;
+        size_t queue_head{}, queue_count{};
+        std::vector<ssize_t> results;
+        std::vector<std::thread> workers;
+        bool stopping{};
+
+        void run() {
+            std::unique_lock lk(mutex);
+            while (true) {
+                cv.wait(lk, [this] { return stopping || queue_count; });
+                if (!queue_count)
+                    return;
+                const auto r = queue[queue_head];
+                queue_head = (queue_head + 1) % queue.size();
+                --queue_count;
+                lk.unlock();
+                const ssize_t n = pread(r.fd, r.buf, r.len, r.off);
+                const ssize_t res = n < 0 ? -errno : n;
+                lk.lock();
+                results[r.slot] = res;
+                done_cv.notify_all();
+            }
+        }
+    public:
+        ThreadEngine(unsigned entries, unsigned threads) {
+            results.assign(entries, 0);
+            queue.resize(entries);
+            for (unsigned i = 0; i < threads; ++i)
+                workers.emplace_back([this] { run(); });
+        }
+        bool submit(uint8_t slot, int fd, void* buf, size_t len, off_t off) override {
+            {
+                std::lock_guard lk(mutex);
+                results[slot] = pending;
+                queue[(queue_head + queue_count++) % queue.size()] = {slot, fd, buf, len, off};
+            }
+            cv.notify_one();
+            return true;
+        }
+        bool ready(uint8_t slot) override {
+            std::lock_guard lk(mutex);
+            return results[slot] != pending;
+        }
+        ssize_t wait(uint8_t slot) override {
+            std::unique_lock lk(mutex);
+            done_cv.wait(lk, [this, slot] { return results[slot] != pending; });
+            return results[slot];
+        }
+        ~ThreadEngine() {
+            {
+                std::lock_guard lk(mutex);
+                stopping = true;
+            }
+            cv.notify_all();
+            for (auto& t : workers)
+                t.join();
+        }
+    };
+
+    struct Slot {
+        uint8_t* buf;
+        uint64_t off;
+        enum { IDLE, INFLIGHT, DONE } state;
+        ssize_t len;     // 从off起已读到的字节数
+        uint8_t retries;
+    };
+
+    Config config;
+    std::unique_ptr<Engine> engine;
+    bool uring{};
+    bool direct{};
+    int fd{-1};
+    uint8_t* pool{};
+    size_t read_size{};
+    std::vector<Slot> slots;
+    uint8_t head{};
+    uint64_t submit_off{}; // 下一次提交读取的文件偏移，RF64文件可超过4GB
+    uint64_t data_end{};
+    std::array<uint32_t, 32> wait_hist{}; // 按等待微秒数的位宽分桶
+    Stats stats{};
+
+    void submit(uint8_t i) {
+        auto& s = slots[i];
+        s.state = Slot::IDLE;
+        if (submit_off >= data_end)
+            return;
+        s.off = submit_off;
+        s.len = 0;
+        s.retries = 0;
+        submit_off += read_size;
+        resume(i);
+    }
+    // 从已读到的位置（向下对齐到4KB）提交本段余下的部分，提交失败时按已读到的数据结束
+    void resume(uint8_t i) {
+        auto& s = slots[i];
+        const uint64_t from = (s.off + s.len) & ~uint64_t(align - 1);
+        s.len = from - s.off;
+        s.state = engine->submit(i, fd, s.buf + s.len, s.off + read_size - from, from) ? Slot::INFLIGHT : Slot::DONE;
+    }
+    void drain() {
+        for (uint8_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].state == Slot::INFLIGHT)
+                engine->wait(i);
+            slots[i].state = Slot::IDLE;
+        }
+    }
+    // 从pos开始重新预读，pos之前的对齐部分读入后跳过
+    void restart(uint64_t pos) {
+        drain();
+        samples_current_index = pos;
+        submit_off = pos & ~uint64_t(align - 1);
+        head = 0;
+        for (uint8_t i = 0; i < slots.size(); ++i)
+            submit(i);
+    }
+    void record_wait(uint32_t us) {
+        ++stats.waits;
+        ++wait_hist[std::bit_width(us)];
+        stats.wait_max_us = std::max(stats.wait_max_us, us);
+    }
+    uint32_t wait_percentile(uint32_t pct) const {
+        const uint64_t target = (uint64_t(stats.waits) * pct + 99) / 100;
+        uint64_t sum = 0;
+        for (size_t b = 0; b < wait_hist.size(); ++b) {
+            sum += wait_hist[b];
+            if (sum >= target && sum)
+                return b ? (1u << b) - 1 : 0;
+        }
+        return 0;
+    }
+    bool setup() {
+        if (engine)
+            return true;
+        const uint8_t depth = std::max<uint8_t>(config.queue_depth, 1);
+        read_size = (std::max<size_t>(config.read_size, 1) + align - 1) & ~(align - 1);
+        pool = static_cast<uint8_t*>(std::aligned_alloc(align, depth * read_size));
+        if (!pool)
+            return false;
+        slots.assign(depth, {});
+        for (uint8_t i = 0; i < depth; ++i)
+            slots[i].buf = pool + i * read_size;
+
+        auto ring = std::make_unique<UringEngine>();
+        uring = ring->init(depth);
+        if (uring)
+            engine = std::move(ring);
+        else
+            engine = std::make_unique<ThreadEngine>(depth, std::min<uint8_t>(depth, 4));
+        return true;
+    }
+    void release() {
+        if (engine)
+            drain();
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+public:
+    UringAudio() = default;
+    UringAudio(Config cfg) : config(cfg) {}
+    UringAudio(const UringAudio&) = delete;
+    UringAudio& operator=(const UringAudio&) = delete;
+
+    // 修改队列深度和读取长度，下一次load()生效
+    void set_config(Config cfg) {
+        release();
+        engine.reset();
+        std::free(pool);
+        pool = nullptr;
+        config = cfg;
+    }
+    Stats get_stats() const {
+        auto s = stats;
+        s.uring = uring;
+        s.direct = direct;
+        s.wait_p50_us = wait_percentile(50);
+        s.wait_p99_us = wait_percentile(99);
+        return s;
+    }
+
+    int8_t load(std::string_view name) override {
+        release();
+        if (name.size() > PathString::capacity())
+            return -1; // 路径过长
+        if (!setup())
+            return -1;
+
+        const int plain = ::open(name.data(), O_RDONLY);
+        if (plain < 0)
+            return -1; // 打开文件失败
+        struct stat st;
+        auto read_at = [plain](uint64_t offset, uint8_t* dst, size_t n) {
+            return pread(plain, dst, n, offset) == static_cast<ssize_t>(n);
+        };
+        if (fstat(plain, &st) != 0 || !parse_wav(read_at, st.st_size)) {
+            ::close(plain);
+            return -1;
+        }
+        data_end = samples_start_index + data_size;
+
+        // O_DIRECT可能在打开或第一次读取时才报错，试读一块确认
+        fd = plain;
+        direct = false;
+        if (config.direct) {
+            const int d = ::open(name.data(), O_RDONLY | O_DIRECT);
+            if (d >= 0 && pread(d, pool, align, 0) >= 0) {
+                ::close(plain);
+                fd = d;
+                direct = true;
+            } else if (d >= 0) {
+                ::close(d);
+            }
+        }
+        restart(samples_start_index);
+
+        this->name = name;
+
+        return 0;
+    }
+    bool is_valid() const override {
+        return fd >= 0;
+    }
+    void close() override {
+        release();
+    }
+    void seek_frame(uint64_t frame) override {
+        if (is_valid())
+            restart(std::min<uint64_t>(samples_start_index + frame * block_align(), data_end));
+    }
+    unsigned read(uint8_t buffer[], unsigned size) override {
+        unsigned copied = 0;
+        while (is_valid() && copied < size && samples_current_index < data_end) {
+            auto& s = slots[head];
+            if (s.state == Slot::INFLIGHT) {
+                ssize_t res;
+                if (engine->ready(head)) {
+                    res = engine->wait(head);
+                } else {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    res = engine->wait(head);
+                    record_wait(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - t0).count());
+                }
+                if (res > 0)
+                    s.len += res;
+                s.state = Slot::DONE;
+                ++stats.reads;
+            }
+            // 出错（如EINTR、EAGAIN或介质一时忙）或短读时本段还没读完，从断处重新提交，而不是立即结束歌曲
+            if (s.state == Slot::DONE && s.off + s.len < std::min<uint64_t>(s.off + read_size, data_end)
+                && s.retries < config.retries) {
+                ++s.retries;
+                ++stats.retries;
+                resume(head);
+                continue;
+            }
+            if (s.state != Slot::DONE || s.len <= 0)
+                break; // 文件结束或多次重试后仍读取出错
+            const uint64_t end = std::min<uint64_t>(s.off + s.len, data_end);
+            if (samples_current_index >= end)
+                break; // 多次重试后仍短读
+            const size_t n = std::min<uint64_t>(end - samples_current_index, size - copied);
+            std::memcpy(buffer + copied, s.buf + (samples_current_index - s.off), n);
+            samples_current_index += n;
+            copied += n;
+            // 槽位用完后立即提交下一段读取
+            if (samples_current_index >= s.off + read_size) {
+                submit(head);
+                head = (head + 1) % slots.size();
+            }
+        }
+        return copied;
+    }
+    ~UringAudio() {
+        release();
+        engine.reset();
+        std::free(pool);
+    }
+};
+
+#endif
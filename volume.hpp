@@ -6,19 +6,15 @@
 #include <algorithm>
 #include <span>
 #include <cmath>
+#include <limits>
 
 class Volume {
 private:
     uint8_t volume{}; // 音量范围 0-100
     float volume_factor{}; // 缓存音量因子
+    float gain_db{}; // 附加增益（响度归一化），折算进音量因子，不增加逐采样开销
     void updateFactor() {
-        if (volume == 0) {
-            volume_factor = 0;
-            return;
-        }
-        constexpr float max_db = 60.0f;
-        const float db_attenuation = (volume / 100.0f * max_db) - max_db;
-        volume_factor = std::pow(10.0f, db_attenuation / 20.0f);
+        volume_factor = volume == 0 ? 0 : std::pow(10.0f, get_db() / 20.0f);
     }
 public:
     Volume(uint8_t vol = 50) { set(vol); }
@@ -29,6 +25,19 @@ public:
         updateFactor();
     }
     uint8_t get() const { return volume; }
+    void set_gain(float db) {
+        if (gain_db == db) return;
+        gain_db = db;
+        updateFactor();
+    }
+    float get_gain() const { return gain_db; }
+    // 音量与附加增益合计的dB值，静音时为负无穷
+    float get_db() const {
+        constexpr float max_db = 60.0f;
+        if (volume == 0)
+            return -INFINITY;
+        return (volume / 100.0f * max_db) - max_db + gain_db;
+    }
 
     template<typename T>
     void apply(std::span<T> buf) const {
@@ -52,9 +61,37 @@ public:
         for (size_t i = 0; i < sz; ++i)
             arr[i] = static_cast<T>(arr[i] * volume_factor);
     }
+    // 从src读取、写入dst，src可以是只读的文件映射
+    template<typename T>
+    void apply(const T* src, T* dst, size_t sz) const {
+        if (volume == 0) {
+            std::fill(dst, dst + sz, 0);
+            return;
+        }
+        for (size_t i = 0; i < sz; ++i)
+            dst[i] = static_cast<T>(src[i] * volume_factor);
+    }
+    // 按任意系数缩放并饱和，用于硬件音量范围之外需要软件补足的部分
+    template<typename T>
+    static void scale(const T* src, T* dst, size_t sz, float factor) {
+        constexpr float lo = std::numeric_limits<T>::min(), hi = std::numeric_limits<T>::max();
+        for (size_t i = 0; i < sz; ++i)
+            dst[i] = static_cast<T>(std::clamp(src[i] * factor, lo, hi));
+    }
     float get_factor() const {
         return volume_factor;
     }
+
+    // 线性渐变，from/to为起止增益系数，用于淡入淡出
+    template<typename T>
+    static void fade(T* arr, size_t sz, float from, float to) {
+        if (sz == 0)
+            return;
+        const float step = (to - from) / sz;
+        float gain = from;
+        for (size_t i = 0; i < sz; ++i, gain += step)
+            arr[i] = static_cast<T>(arr[i] * gain);
+    }
 };
 
 #endif // VOLUME_H